@@ -0,0 +1,52 @@
+#ifndef COLD_STORE_H
+#define COLD_STORE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define COLD_SLOT_SIZE 64u         // one slot never straddles a page
+#define COLD_STORE_MIN_SLOTS 1024u
+#define COLD_SLOT_NONE UINT32_MAX  // tombstoned index entry
+#define COLD_STORE_NOT_FOUND SIZE_MAX
+#define COLD_PROMOTE_READS 2u      // reads of a spilled record that request its promotion
+
+// Sorted by hash, mirroring the resident chain; 8 bytes per spilled record.
+typedef struct {
+    uint32_t hash;
+    uint32_t slot;
+} ColdIndexEntry;
+
+// Spilled records live in fixed-size slots of a memory-mapped file; only the
+// compact index stays resident. All mutation happens under the table's write
+// lock, lookups under the read lock.
+typedef struct {
+    int fd;
+    unsigned char *map;
+    size_t slot_capacity;
+    size_t slot_count;   // slots handed out so far
+    atomic_uchar *heat;  // per-slot read count since the record was spilled
+    uint32_t *free_slots;
+    size_t free_count;
+    size_t free_capacity;
+    ColdIndexEntry *index;
+    size_t index_count;  // includes tombstones
+    size_t index_capacity;
+    size_t live;
+} ColdStore;
+
+// Creates an unlinked segment in `directory` (NULL: $TMPDIR, then /tmp).
+int cold_store_open(ColdStore *store, const char *directory);
+void cold_store_close(ColdStore *store);
+int cold_store_write(ColdStore *store, uint32_t hash, const char *name, uint32_t salary, uint32_t *slot);
+// Merges entries (sorted by hash, slots from cold_store_write) into the index.
+int cold_store_add_entries(ColdStore *store, const ColdIndexEntry *entries, size_t count);
+size_t cold_store_find(const ColdStore *store, uint32_t hash, const char *name);
+void cold_store_read(const ColdStore *store, uint32_t slot, char *name, size_t name_size, uint32_t *salary);
+void cold_store_remove(ColdStore *store, size_t position);
+// Safe under the read lock; returns 1 for exactly the read that reaches COLD_PROMOTE_READS.
+int cold_store_note_read(ColdStore *store, uint32_t slot);
+void cold_store_reset_heat(ColdStore *store, uint32_t slot);
+size_t cold_store_file_bytes(const ColdStore *store);
+
+#endif // COLD_STORE_H
@@ -5,16 +5,32 @@
 
 #include "commands.h"
 #include "hash_table.h"
+#include "hot_cache.h"
+#include "latency_stats.h"
 #include "logger.h"
 #include "output_writer.h"
 
+#define TABLE_REPORT_MAX 2048 // "Table Statistics:" block with hot-cache lines
+
 typedef struct {
     HashTable *table;
     Logger *logger;
     OutputWriter *output;
+    LatencyStats *stats;
+    HotCachePool *hot_cache; // optional; NULL disables the SEARCH cache
     Command command;
+    size_t sequence; // position in the command file; orders output blocks
+    OutputBlock block;
+    LatencyRecorder recorder;
+    uint64_t lock_acquired_ns;
 } CommandContext;
 
 void *command_worker(void *arg);
+// Writes the STATS / SIGUSR1 report (table counters, then hot-cache counters
+// when `hot_cache` is set) into `buffer`, flushing the calling thread's
+// counters first. With `ctx` the snapshot is taken under that command's logged
+// and timed read lock; without one the lock is taken directly. Returns the
+// report length, or -1 if it does not fit.
+int format_table_report(HashTable *table, HotCachePool *hot_cache, CommandContext *ctx, char *buffer, size_t size);
 
 #endif // COMMAND_PROCESSOR_H
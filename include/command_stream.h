@@ -0,0 +1,38 @@
+#ifndef COMMAND_STREAM_H
+#define COMMAND_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "commands.h"
+
+/*
+ * Compact binary command stream.
+ *
+ * Header (16 bytes, little endian):
+ *   char     magic[4]      "CHSB"
+ *   uint16_t version       COMMAND_STREAM_VERSION
+ *   uint16_t flags         reserved, 0
+ *   uint32_t record_count
+ *   uint32_t checksum      CRC-32 (IEEE) of every byte after the header
+ *
+ * Record:
+ *   uint8_t  type          CommandType
+ *   varint   priority      LEB128, at most 5 bytes
+ *   varint   salary        INSERT only
+ *   uint32_t hash          Jenkins hash of name (INSERT/DELETE/SEARCH), used as-is
+ *   uint8_t  name_length   <= HASH_NAME_MAX
+ *   char     name[name_length]
+ *
+ * The loader checks the checksum once instead of rehashing every name.
+ */
+
+#define COMMAND_STREAM_MAGIC "CHSB"
+#define COMMAND_STREAM_VERSION 2u
+#define COMMAND_STREAM_HEADER_SIZE 16u
+
+int command_stream_is_binary(const char *path);
+int command_stream_write(const char *path, const CommandList *list, char *error_message, size_t error_size);
+int command_stream_load(const char *path, CommandList *list, char *error_message, size_t error_size);
+
+#endif // COMMAND_STREAM_H
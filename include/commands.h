@@ -10,7 +10,8 @@ typedef enum {
     COMMAND_INSERT,
     COMMAND_DELETE,
     COMMAND_SEARCH,
-    COMMAND_PRINT
+    COMMAND_PRINT,
+    COMMAND_STATS
 } CommandType;
 
 typedef struct {
@@ -18,6 +19,7 @@ typedef struct {
     char name[HASH_NAME_MAX + 1];
     uint32_t salary;
     uint32_t priority;
+    uint32_t hash;
 } Command;
 
 typedef struct {
@@ -27,7 +29,12 @@ typedef struct {
 } CommandList;
 
 int load_commands(const char *path, CommandList *list, char *error_message, size_t error_size);
+// Same, but splits a regular file into `chunk_count` parse chunks (at most 64);
+// 0 picks the count from the file size and the online cores.
+int load_commands_chunked(const char *path, CommandList *list, size_t chunk_count,
+                          char *error_message, size_t error_size);
 void free_command_list(CommandList *list);
 const char *command_type_to_string(CommandType type);
+int command_type_has_name(CommandType type);
 
 #endif // COMMANDS_H
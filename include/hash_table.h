@@ -1,34 +1,142 @@
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <pthread.h>
 
+#include "cold_store.h"
+#include "membership_filter.h"
+#include "numa_topology.h"
+
 #define HASH_NAME_MAX 50
+#define HASH_TABLE_VERSION_STRIPES 1024u
+#define HASH_TABLE_AGE_BUCKETS 64u
+#define HASH_TABLE_MIN_RESIDENT 256u // records tiering always keeps resident
+#define HASH_TABLE_EPOCH_WRITES 256u // writes per access epoch while tiering
+#define HASH_TABLE_PROMOTION_QUEUE 64u
 
 typedef struct hash_struct {
     uint32_t hash;
     char name[HASH_NAME_MAX + 1];
     uint32_t salary;
+    atomic_uint last_access; // access epoch, refreshed by readers for tiering
     struct hash_struct *next;
 } hashRecord;
 
+// A spilled key that readers keep hitting; promoted by the next writer.
+typedef struct {
+    uint32_t hash;
+    char name[HASH_NAME_MAX + 1];
+} PromotionRequest;
+
+// Operation counters; threads accumulate privately and publish on flush.
+typedef struct {
+    atomic_uint_fast64_t lookups;
+    atomic_uint_fast64_t inserts;
+    atomic_uint_fast64_t updates;
+    atomic_uint_fast64_t deletes;
+    atomic_uint_fast64_t delete_misses;
+    atomic_uint_fast64_t probes;
+    atomic_uint_fast64_t max_probe;
+    atomic_uint_fast64_t read_locks;
+    atomic_uint_fast64_t write_locks;
+    atomic_uint_fast64_t contended_locks;
+} HashTableCounters;
+
 typedef struct {
     hashRecord *head;
     pthread_rwlock_t rwlock;
+    HashTableCounters counters;
+    // Bumped by writers (under the write lock) for every key in the stripe
+    // `hash % HASH_TABLE_VERSION_STRIPES`; lets lock-free caches validate entries.
+    atomic_uint_fast64_t versions[HASH_TABLE_VERSION_STRIPES];
+    // Approximate membership of every key, consulted before taking the lock.
+    MembershipFilter filter;
+    size_t record_count;
+    // Tiering: with a non-zero memory_cap, the least recently used resident
+    // records are spilled to `cold` once resident bytes exceed the cap.
+    size_t memory_cap;
+    size_t resident_count;
+    ColdStore cold;
+    atomic_uint access_epoch;
+    size_t writes_this_epoch;
+    pthread_mutex_t promotion_mutex; // readers queue requests under the read lock
+    PromotionRequest promotion_queue[HASH_TABLE_PROMOTION_QUEUE];
+    size_t promotion_count;
+    uint64_t evictions;
+    uint64_t promotions;
+    int cap_exceeded; // the cold index alone outgrew the cap; eviction stopped
+    // Optional node-local record storage; NULL allocates records with calloc.
+    NumaObjectPool *record_pool;
 } HashTable;
 
+typedef struct {
+    uint64_t records;
+    uint64_t memory_bytes;
+    uint64_t chain_length;
+    uint64_t hash_collisions;
+    uint64_t lookups;
+    uint64_t inserts;
+    uint64_t updates;
+    uint64_t deletes;
+    uint64_t delete_misses;
+    uint64_t probes;
+    uint64_t max_probe;
+    uint64_t read_locks;
+    uint64_t write_locks;
+    uint64_t contended_locks;
+    uint64_t filter_capacity;
+    uint64_t filter_counters;
+    uint64_t filter_rejections;
+    uint64_t filter_false_positives;
+    uint64_t filter_rebuilds;
+    double filter_fp_rate;
+    uint64_t memory_cap;
+    uint64_t resident_records;
+    uint64_t cold_records;
+    uint64_t cold_file_bytes;
+    uint64_t evictions;
+    uint64_t promotions;
+    uint64_t cap_exceeded;
+} HashTableStats;
+
 void hash_table_init(HashTable *table);
 void hash_table_destroy(HashTable *table);
+// Caps resident record memory, spilling cold records to an unlinked segment
+// in `directory` (NULL: $TMPDIR, then /tmp). Fails for caps below
+// hash_table_min_memory_cap().
+int hash_table_enable_tiering(HashTable *table, size_t memory_cap, const char *directory);
+size_t hash_table_min_memory_cap(void);
+// Turns the negative-lookup filter on (rebuilding it from the current records)
+// or off; caller holds the write lock or runs before any worker starts.
+void hash_table_set_filter_enabled(HashTable *table, int enabled);
+// Allocates records from `pool` on the node that owns their key
+// (numa_node_for_hash). Call before any record is inserted.
+void hash_table_set_record_pool(HashTable *table, NumaObjectPool *pool);
+// Parses a byte count with an optional K, M or G suffix; -1 on junk or overflow.
+int hash_table_parse_memory_cap(const char *text, size_t *memory_cap);
 
 uint32_t jenkins_one_at_a_time_hash(const char *key);
 
-hashRecord *hash_table_find(HashTable *table, const char *name);
+// `hash` must be jenkins_one_at_a_time_hash(name); callers already carry it.
+// Spilled records are returned as a per-thread copy valid until the next call.
+hashRecord *hash_table_find(HashTable *table, const char *name, uint32_t hash);
 int hash_table_insert_locked(HashTable *table, const char *name, uint32_t salary,
                              uint32_t hash, uint32_t *prev_salary, int *was_update);
 int hash_table_delete_locked(HashTable *table, const char *name, uint32_t hash,
                              uint32_t *removed_salary);
 
 hashRecord *hash_table_clone_records(HashTable *table, size_t *out_count);
+uint64_t hash_table_version(HashTable *table, uint32_t hash);
+// Recency clock used by tiering; it only moves while a memory cap is set.
+unsigned hash_table_access_epoch(HashTable *table);
+
+void hash_table_count_lock(int write, int contended);
+void hash_table_flush_thread_counters(HashTable *table);
+// Caller must hold the table lock (read is enough).
+void hash_table_collect_stats(HashTable *table, HashTableStats *stats);
+int hash_table_format_stats(const HashTableStats *stats, char *buffer, size_t size);
 
 #endif // HASH_TABLE_H
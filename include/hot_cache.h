@@ -0,0 +1,64 @@
+#ifndef HOT_CACHE_H
+#define HOT_CACHE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash_table.h"
+
+#define HOT_CACHE_ENTRIES 1024u // direct mapped by hash, power of two
+#define HOT_CACHE_POOL_MAX 16u   // caches ever allocated; beyond it SEARCH runs uncached
+
+typedef struct {
+    uint64_t version;
+    unsigned epoch; // table access epoch at store time
+    uint32_t hash;
+    uint32_t salary;
+    int valid;
+    char name[HASH_NAME_MAX + 1];
+} HotCacheEntry;
+
+// Private to one thread at a time. Entries are (hash, name) -> salary snapshots
+// taken under the read lock and valid while the key's table version is unchanged.
+// An entry also misses once the table's access epoch moves on, so a hot key
+// goes through the locked lookup once per epoch and tiering sees it as recent.
+typedef struct HotKeyCache {
+    HotCacheEntry entries[HOT_CACHE_ENTRIES];
+    atomic_uint_fast64_t hits;   // single writer, read by reporters
+    atomic_uint_fast64_t misses;
+    struct HotKeyCache *next;      // every cache in the pool
+    struct HotKeyCache *next_free; // caches not checked out
+} HotKeyCache;
+
+// Caches outlive the short-lived command threads: a thread checks one out,
+// uses it exclusively, and returns it for the next command. Never hold a
+// checked-out cache while blocking on the table lock.
+typedef struct {
+    pthread_mutex_t mutex;
+    HotKeyCache *all;
+    HotKeyCache *free_list;
+    size_t count;
+} HotCachePool;
+
+typedef struct {
+    uint64_t caches;
+    uint64_t hits;
+    uint64_t misses;
+} HotCacheStats;
+
+void hot_cache_init(HotKeyCache *cache);
+int hot_cache_lookup(HotKeyCache *cache, HashTable *table, uint32_t hash, const char *name, uint32_t *salary);
+// Caller must hold the table lock so the recorded version matches the salary.
+void hot_cache_store(HotKeyCache *cache, HashTable *table, uint32_t hash, const char *name, uint32_t salary);
+
+int hot_cache_pool_init(HotCachePool *pool);
+void hot_cache_pool_destroy(HotCachePool *pool);
+// Returns NULL when all HOT_CACHE_POOL_MAX caches are checked out.
+HotKeyCache *hot_cache_pool_acquire(HotCachePool *pool);
+void hot_cache_pool_release(HotCachePool *pool, HotKeyCache *cache);
+void hot_cache_pool_collect_stats(HotCachePool *pool, HotCacheStats *stats);
+int hot_cache_format_stats(const HotCacheStats *stats, char *buffer, size_t size);
+
+#endif // HOT_CACHE_H
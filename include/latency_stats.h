@@ -0,0 +1,73 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Log-linear (HDR-style) buckets: exact below 32 ns, then 16 sub-buckets per
+// power of two (~6% precision) up to 2^40 ns.
+#define LATENCY_SUB_BUCKET_BITS 4
+#define LATENCY_SUB_BUCKET_COUNT (1u << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_MAX_MAGNITUDE 39
+#define LATENCY_BUCKET_COUNT ((LATENCY_MAX_MAGNITUDE - LATENCY_SUB_BUCKET_BITS + 2) * LATENCY_SUB_BUCKET_COUNT)
+
+#define LATENCY_RECORDER_CAPACITY 8
+
+typedef enum {
+    LATENCY_READ_LOCK_WAIT,
+    LATENCY_READ_LOCK_HOLD,
+    LATENCY_WRITE_LOCK_WAIT,
+    LATENCY_WRITE_LOCK_HOLD,
+    LATENCY_INSERT,
+    LATENCY_DELETE,
+    LATENCY_SEARCH,
+    LATENCY_PRINT,
+    LATENCY_STATS,
+    LATENCY_METRIC_COUNT
+} LatencyMetric;
+
+typedef struct {
+    uint64_t counts[LATENCY_BUCKET_COUNT];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max;
+} LatencyHistogram;
+
+// Shared histogram; flushed into with relaxed atomics like HashTableCounters,
+// so recording never takes a lock. Read with latency_stats_snapshot.
+typedef struct {
+    atomic_uint_fast64_t counts[LATENCY_BUCKET_COUNT];
+    atomic_uint_fast64_t total;
+    atomic_uint_fast64_t sum;
+    atomic_uint_fast64_t max;
+} LatencySharedHistogram;
+
+typedef struct {
+    LatencySharedHistogram metrics[LATENCY_METRIC_COUNT];
+} LatencyStats;
+
+// Per-thread sample buffer, published to the shared stats on flush.
+typedef struct {
+    struct {
+        LatencyMetric metric;
+        uint64_t nanoseconds;
+    } samples[LATENCY_RECORDER_CAPACITY];
+    size_t count;
+} LatencyRecorder;
+
+void latency_histogram_reset(LatencyHistogram *histogram);
+void latency_histogram_record(LatencyHistogram *histogram, uint64_t nanoseconds);
+void latency_histogram_merge(LatencyHistogram *target, const LatencyHistogram *source);
+uint64_t latency_histogram_percentile(const LatencyHistogram *histogram, double percentile);
+
+int latency_stats_init(LatencyStats *stats);
+void latency_stats_destroy(LatencyStats *stats);
+void latency_stats_snapshot(LatencyStats *stats, LatencyMetric metric, LatencyHistogram *out);
+int latency_stats_write_report(LatencyStats *stats, const char *path);
+const char *latency_metric_to_string(LatencyMetric metric);
+
+void latency_recorder_add(LatencyRecorder *recorder, LatencyStats *stats, LatencyMetric metric, uint64_t nanoseconds);
+void latency_recorder_flush(LatencyRecorder *recorder, LatencyStats *stats);
+
+#endif // LATENCY_STATS_H
@@ -2,17 +2,49 @@
 #define LOGGER_H
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdint.h>
-#include <stdio.h>
 
+#define LOGGER_RING_CAPACITY 8192u // entries, power of two
+#define LOGGER_TEXT_MAX 104
+
+typedef struct {
+    atomic_size_t sequence;
+    long long timestamp;
+    uint32_t priority;
+    uint32_t kind;
+    uint32_t hash;   // keyed command entries only
+    uint32_t salary; // INSERT entries only
+    char text[LOGGER_TEXT_MAX]; // name for keyed commands, else the message
+} LogEntry;
+
+// Producers claim ring slots lock-free; a background thread formats and
+// writes claimed entries to the log file in batches. The flusher sleeps on
+// `wake` when the ring is empty and producers signal it only while it sleeps.
 typedef struct {
-    FILE *fp;
+    int fd;
+    LogEntry *ring;
+    char *batch;
+    atomic_size_t head;
+    size_t tail;
+    long long last_timestamp; // flusher-only; keeps file timestamps non-decreasing
+    int write_error;
+    atomic_int running;
+    atomic_int sleeping;
     pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_t flusher;
 } Logger;
 
 int logger_init(Logger *logger, const char *path);
 void logger_close(Logger *logger);
 void logger_log_command(Logger *logger, uint32_t priority, const char *format, ...);
+// Keyed commands store hash, name and salary raw; the flusher formats the
+// "INSERT,hash,name,salary" style line, so producers never run printf.
+void logger_log_insert(Logger *logger, uint32_t priority, uint32_t hash, const char *name, uint32_t salary);
+void logger_log_delete(Logger *logger, uint32_t priority, uint32_t hash, const char *name);
+void logger_log_search(Logger *logger, uint32_t priority, uint32_t hash, const char *name);
 void logger_log_status(Logger *logger, uint32_t priority, const char *status);
 
 #endif // LOGGER_H
@@ -0,0 +1,73 @@
+#ifndef MEMBERSHIP_FILTER_H
+#define MEMBERSHIP_FILTER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FILTER_HASH_COUNT 4
+#define FILTER_COUNTERS_PER_KEY 12    // ~0.6% false positives at capacity
+#define FILTER_MIN_CAPACITY 1024u
+#define FILTER_TARGET_FP_RATE 0.01
+#define FILTER_REBUILD_FP_RATE (3 * FILTER_TARGET_FP_RATE)
+#define FILTER_MIN_SAMPLES 1024u
+#define FILTER_MAX_SAMPLES (FILTER_MIN_SAMPLES << 10)
+
+// Why membership_filter_needs_rebuild wants a new table.
+#define FILTER_REBUILD_NONE 0
+#define FILTER_REBUILD_RESIZE 1 // missing, overloaded or four times oversized
+#define FILTER_REBUILD_DRIFT 2  // measured false-positive rate too high
+
+typedef struct FilterTable {
+    size_t capacity; // keys the table was sized for
+    size_t mask;     // counter count - 1 (power of two)
+    uint32_t seed;   // mixed into both probe hashes; a reseed moves every key
+    struct FilterTable *retired_next;
+    atomic_uchar counters[];
+} FilterTable;
+
+// Counting Bloom filter: writers update it under the table's write lock, readers
+// query it without any lock. Counters saturate at 255 and then stay put, so the
+// filter never produces a false negative. Replaced tables are retired and freed
+// by a later writer once no lock-free reader is inside a query.
+typedef struct {
+    _Atomic(FilterTable *) current;
+    FilterTable *retired;
+    atomic_uint_fast64_t active_readers;
+    int enabled;
+    atomic_uint_fast64_t rejections;      // queries answered "absent"
+    atomic_uint_fast64_t false_positives; // "maybe" answers the table then missed
+    atomic_uint_fast64_t window_rejections;
+    atomic_uint_fast64_t window_false_positives;
+    uint64_t window_samples; // misses a window needs before it can force a drift rebuild
+    uint32_t next_seed;
+    uint64_t rebuilds;
+} MembershipFilter;
+
+FilterTable *filter_table_create(size_t capacity, uint32_t seed);
+void filter_table_add(FilterTable *table, uint32_t hash, const char *name);
+
+int membership_filter_init(MembershipFilter *filter, int enabled);
+void membership_filter_destroy(MembershipFilter *filter);
+// Setup-time switch. While disabled, queries answer "maybe" and writers skip
+// maintenance, so enabling over existing keys needs a rebuild (see
+// hash_table_set_filter_enabled).
+void membership_filter_set_enabled(MembershipFilter *filter, int enabled);
+void membership_filter_add(MembershipFilter *filter, uint32_t hash, const char *name);
+void membership_filter_remove(MembershipFilter *filter, uint32_t hash, const char *name);
+int membership_filter_may_contain(MembershipFilter *filter, uint32_t hash, const char *name);
+void membership_filter_note_false_positive(MembershipFilter *filter);
+// Returns FILTER_REBUILD_RESIZE when the table is missing, overloaded or four
+// times oversized, FILTER_REBUILD_DRIFT when a full sample window measured too
+// many false positives, else FILTER_REBUILD_NONE. A window that stays under the
+// threshold restarts the measurement and relaxes the drift backoff.
+int membership_filter_needs_rebuild(MembershipFilter *filter, size_t records);
+// Allocates the empty table a rebuild for `reason` should fill. Resizes keep the
+// seed and size for twice `records`. Drift rebuilds take a fresh seed and up to
+// double the capacity, and double the samples the next drift needs.
+FilterTable *membership_filter_rebuild_table(MembershipFilter *filter, size_t records, int reason);
+// Swaps in a table built by the caller; caller holds the write lock.
+void membership_filter_publish(MembershipFilter *filter, FilterTable *table);
+double membership_filter_fp_rate(MembershipFilter *filter);
+
+#endif // MEMBERSHIP_FILTER_H
@@ -0,0 +1,62 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NUMA_MAX_NODES 64
+#define NUMA_POOL_CHUNK_BYTES (256u * 1024u)
+
+typedef struct {
+    int id;
+    int *cpus;
+    size_t cpu_count;
+    atomic_size_t next_cpu;
+} NumaNode;
+
+// Nodes discovered from sysfs. Placement is only enabled when more than one
+// node has CPUs; otherwise every call below is a no-op.
+typedef struct {
+    NumaNode nodes[NUMA_MAX_NODES];
+    size_t node_count;
+    int enabled;
+} NumaTopology;
+
+int numa_topology_init(NumaTopology *topology, const char *sysfs_root);
+void numa_topology_destroy(NumaTopology *topology);
+
+// Keys are owned by node `hash % node_count`; commands on a key run there so the
+// records they allocate are first-touched on, and later read from, that node.
+size_t numa_node_for_hash(const NumaTopology *topology, uint32_t hash);
+// Pins threads created with `attr` to the next CPU (round robin) of `node`.
+int numa_pin_thread_attr(NumaTopology *topology, size_t node, pthread_attr_t *attr);
+
+// Page-aligned allocation interleaved across nodes, for structures every worker reads.
+void *numa_alloc_interleaved(const NumaTopology *topology, size_t size);
+void numa_free_interleaved(void *memory, size_t size);
+
+typedef struct NumaPoolChunk {
+    struct NumaPoolChunk *next;
+    size_t bytes;
+} NumaPoolChunk;
+
+// Fixed-size objects carved from chunks bound to one node, with a free list
+// per node so a freed object is only reused on the node that holds its pages.
+// Not thread-safe: the hash table uses it under its write lock.
+typedef struct {
+    const NumaTopology *topology;
+    size_t object_size;
+    size_t stride;
+    void *free_lists[NUMA_MAX_NODES];
+    NumaPoolChunk *chunks;
+} NumaObjectPool;
+
+int numa_pool_init(NumaObjectPool *pool, const NumaTopology *topology, size_t object_size);
+void numa_pool_destroy(NumaObjectPool *pool);
+// Returns a zeroed object on `node` (an index as from numa_node_for_hash).
+void *numa_pool_alloc(NumaObjectPool *pool, size_t node);
+void numa_pool_free(NumaObjectPool *pool, void *object);
+
+#endif // NUMA_TOPOLOGY_H
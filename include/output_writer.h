@@ -2,16 +2,58 @@
 #define OUTPUT_WRITER_H
 
 #include <pthread.h>
-#include <stdio.h>
+#include <stddef.h>
+
+#define OUTPUT_TO_FILE 1u
+#define OUTPUT_TO_CONSOLE 2u
+#define OUTPUT_TO_BOTH (OUTPUT_TO_FILE | OUTPUT_TO_CONSOLE)
+#define OUTPUT_REORDER_CAPACITY 4096u // committers further ahead than this wait
 
 typedef struct {
-    FILE *fp;
+    char *data;
+    size_t length;
+    size_t capacity;
+    unsigned targets;
+} OutputSegment;
+
+// Output built privately by one command and written contiguously, in
+// sequence order, once committed.
+typedef struct OutputBlock {
+    OutputSegment *segments;
+    size_t count;
+    size_t capacity;
+    size_t sequence;
+    struct OutputBlock *next;
+} OutputBlock;
+
+typedef struct {
+    int fd;
+    int console_fd;
     pthread_mutex_t mutex;
+    pthread_cond_t advanced; // next_sequence moved; the window has room again
+    // Reorder buffer: committed blocks wait in `pending[sequence % pending_capacity]`
+    // until every lower sequence number has been written. Only sequences in
+    // [next_sequence, next_sequence + pending_capacity) are parked, so each
+    // slot belongs to exactly one of them.
+    OutputBlock **pending;
+    size_t pending_capacity;
+    size_t next_sequence;
+    int writing;
 } OutputWriter;
 
+void output_block_init(OutputBlock *block);
+void output_block_free(OutputBlock *block);
+int output_block_append(OutputBlock *block, unsigned targets, const char *text);
+int output_block_appendf(OutputBlock *block, unsigned targets, const char *format, ...);
+int output_block_attach(OutputBlock *block, unsigned targets, char *data, size_t length);
+// Writes the segments addressed to `target` straight to `fd`, bypassing any writer.
+void output_block_write(const OutputBlock *block, int fd, unsigned target);
+
 int output_writer_init(OutputWriter *writer, const char *path);
 void output_writer_close(OutputWriter *writer);
-int output_writer_append(OutputWriter *writer, const char *text);
-int output_writer_appendf(OutputWriter *writer, const char *format, ...);
+// Every sequence number must be committed exactly once, even with an empty
+// block. If the block cannot be queued its output is dropped, but the sequence
+// still counts as written so later blocks are not held back.
+int output_writer_commit(OutputWriter *writer, size_t sequence, OutputBlock *block);
 
 #endif // OUTPUT_WRITER_H
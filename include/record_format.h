@@ -0,0 +1,15 @@
+#ifndef RECORD_FORMAT_H
+#define RECORD_FORMAT_H
+
+#include <stddef.h>
+
+#include "hash_table.h"
+#include "output_writer.h"
+
+// Longest "hash,name,salary\n" line: two 10-digit integers, the name, two commas and a newline.
+#define RECORD_LINE_MAX (10 + 1 + HASH_NAME_MAX + 1 + 10 + 1)
+
+size_t format_record_line(char *out, const hashRecord *record);
+int append_record_listing(OutputBlock *block, unsigned targets, const hashRecord *records, size_t count);
+
+#endif // RECORD_FORMAT_H
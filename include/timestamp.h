@@ -1,6 +1,24 @@
 #ifndef TIMESTAMP_H
 #define TIMESTAMP_H
 
+#include <stdint.h>
+
+typedef enum {
+    CLOCK_SOURCE_TSC,
+    CLOCK_SOURCE_MONOTONIC,
+    CLOCK_SOURCE_MONOTONIC_COARSE
+} ClockSource;
+
+// Selects and calibrates the clock source (CHASH_CLOCK=tsc|monotonic|coarse
+// overrides the automatic choice) and anchors it to wall-clock time. Call it
+// once from main before starting threads; until then readings come from an
+// uncalibrated CLOCK_MONOTONIC.
+void timestamp_init(void);
+ClockSource timestamp_clock_source(void);
+const char *timestamp_clock_source_name(void);
+
+// Microseconds since the epoch, derived from the monotonic source.
 long long current_timestamp_microseconds(void);
+uint64_t monotonic_nanoseconds(void);
 
 #endif // TIMESTAMP_H
@@ -1,20 +1,138 @@
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "command_processor.h"
+#include "command_stream.h"
 #include "commands.h"
 #include "hash_table.h"
+#include "hot_cache.h"
+#include "latency_stats.h"
 #include "logger.h"
+#include "numa_topology.h"
 #include "output_writer.h"
+#include "timestamp.h"
 
 #define COMMANDS_FILE "commands.txt"
 #define OUTPUT_FILE "output.txt"
 #define LOG_FILE "hash.log"
+#define STATS_FILE "stats.txt"
 
-int main(void) {
+typedef struct {
+    HashTable *table;
+    HotCachePool *hot_cache;
+    sigset_t signals;
+    atomic_int stopping;
+    pthread_t thread;
+} SignalWatcher;
+
+static void dump_table_stats(HashTable *table, HotCachePool *hot_cache) {
+    char buffer[TABLE_REPORT_MAX];
+    if (format_table_report(table, hot_cache, NULL, buffer, sizeof(buffer)) >= 0) {
+        fputs(buffer, stderr);
+    }
+}
+
+// SIGUSR1 is blocked in every thread; this one waits for it synchronously so the
+// dump can take locks and allocate safely.
+static void *signal_watcher_main(void *arg) {
+    SignalWatcher *watcher = (SignalWatcher *)arg;
+    for (;;) {
+        int signal_number = 0;
+        if (sigwait(&watcher->signals, &signal_number) != 0) {
+            continue;
+        }
+        if (atomic_load(&watcher->stopping)) {
+            break;
+        }
+        dump_table_stats(watcher->table, watcher->hot_cache);
+    }
+    return NULL;
+}
+
+static int signal_watcher_start(SignalWatcher *watcher, HashTable *table, HotCachePool *hot_cache) {
+    watcher->table = table;
+    watcher->hot_cache = hot_cache;
+    atomic_init(&watcher->stopping, 0);
+    sigemptyset(&watcher->signals);
+    sigaddset(&watcher->signals, SIGUSR1);
+    return pthread_create(&watcher->thread, NULL, signal_watcher_main, watcher) == 0 ? 0 : -1;
+}
+
+static void signal_watcher_stop(SignalWatcher *watcher) {
+    atomic_store(&watcher->stopping, 1);
+    pthread_kill(watcher->thread, SIGUSR1);
+    pthread_join(watcher->thread, NULL);
+}
+
+static CommandContext *allocate_contexts(const NumaTopology *numa, size_t count) {
+    if (numa->enabled) {
+        return (CommandContext *)numa_alloc_interleaved(numa, count * sizeof(CommandContext));
+    }
+    return (CommandContext *)calloc(count, sizeof(CommandContext));
+}
+
+static void free_contexts(const NumaTopology *numa, CommandContext *contexts, size_t count) {
+    if (numa->enabled) {
+        numa_free_interleaved(contexts, count * sizeof(CommandContext));
+    } else {
+        free(contexts);
+    }
+}
+
+// With CHASH_NUMA set, commands on a key are pinned to a core on the node that
+// owns it, which is also the node its record is allocated on.
+static int create_command_thread(NumaTopology *numa, pthread_t *thread, CommandContext *context) {
+    pthread_attr_t attr;
+    pthread_attr_t *attr_ptr = NULL;
+    if (numa->enabled && command_type_has_name(context->command.type) && pthread_attr_init(&attr) == 0) {
+        size_t node = numa_node_for_hash(numa, context->command.hash);
+        if (numa_pin_thread_attr(numa, node, &attr) == 0) {
+            attr_ptr = &attr;
+        } else {
+            pthread_attr_destroy(&attr);
+        }
+    }
+    int rc = pthread_create(thread, attr_ptr, command_worker, context);
+    if (attr_ptr) {
+        pthread_attr_destroy(attr_ptr);
+        if (rc != 0) {
+            // The core may be outside our allowed CPU set; run unpinned instead.
+            rc = pthread_create(thread, NULL, command_worker, context);
+        }
+    }
+    return rc;
+}
+
+int main(int argc, char **argv) {
+    const char *commands_path = argc > 1 ? argv[1] : COMMANDS_FILE;
+    timestamp_init();
+
+    // Block SIGUSR1 before any thread exists so only the watcher receives it.
+    sigset_t blocked;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &blocked, NULL);
     HashTable table;
     hash_table_init(&table);
+    const char *filter_option = getenv("CHASH_FILTER");
+    if (filter_option && strcmp(filter_option, "0") != 0) {
+        hash_table_set_filter_enabled(&table, 1);
+    }
+    const char *memory_cap_option = getenv("CHASH_MEMORY_CAP");
+    if (memory_cap_option) {
+        size_t memory_cap = 0;
+        if (hash_table_parse_memory_cap(memory_cap_option, &memory_cap) != 0 || memory_cap == 0) {
+            fprintf(stderr, "Ignoring invalid CHASH_MEMORY_CAP value: %s\n", memory_cap_option);
+        } else if (memory_cap < hash_table_min_memory_cap()) {
+            fprintf(stderr, "Ignoring CHASH_MEMORY_CAP below the %zu-byte minimum: %s\n", hash_table_min_memory_cap(),
+                    memory_cap_option);
+        } else if (hash_table_enable_tiering(&table, memory_cap, getenv("CHASH_COLD_DIR")) != 0) {
+            fprintf(stderr, "Tiered storage disabled: unable to create the cold segment\n");
+        }
+    }
 
     Logger logger;
     if (logger_init(&logger, LOG_FILE) != 0) {
@@ -31,7 +149,10 @@ int main(void) {
 
     CommandList commands;
     char error_buffer[256];
-    if (load_commands(COMMANDS_FILE, &commands, error_buffer, sizeof(error_buffer)) != 0) {
+    int load_status = command_stream_is_binary(commands_path)
+                          ? command_stream_load(commands_path, &commands, error_buffer, sizeof(error_buffer))
+                          : load_commands(commands_path, &commands, error_buffer, sizeof(error_buffer));
+    if (load_status != 0) {
         fprintf(stderr, "Error loading commands: %s\n", error_buffer);
         output_writer_close(&output);
         logger_close(&logger);
@@ -48,27 +169,65 @@ int main(void) {
         return EXIT_SUCCESS;
     }
 
+    LatencyStats stats;
+    int stats_enabled = latency_stats_init(&stats) == 0;
+    if (!stats_enabled) {
+        fprintf(stderr, "Latency statistics disabled: initialization failed.\n");
+    }
+
     pthread_t *threads = (pthread_t *)calloc(commands.size, sizeof(pthread_t));
     int *thread_created = (int *)calloc(commands.size, sizeof(int));
-    CommandContext *contexts = (CommandContext *)calloc(commands.size, sizeof(CommandContext));
+    NumaTopology numa;
+    const char *numa_option = getenv("CHASH_NUMA");
+    if (numa_option && strcmp(numa_option, "0") != 0) {
+        numa_topology_init(&numa, NULL);
+    } else {
+        memset(&numa, 0, sizeof(numa));
+    }
+    NumaObjectPool record_pool;
+    int record_pool_enabled = numa.enabled && numa_pool_init(&record_pool, &numa, sizeof(hashRecord)) == 0;
+    if (record_pool_enabled) {
+        hash_table_set_record_pool(&table, &record_pool);
+    }
+    CommandContext *contexts = allocate_contexts(&numa, commands.size);
     if (!threads || !thread_created || !contexts) {
         fprintf(stderr, "Failed to allocate thread resources.\n");
         free(threads);
         free(thread_created);
-        free(contexts);
+        free_contexts(&numa, contexts, commands.size);
+        if (stats_enabled) {
+            latency_stats_destroy(&stats);
+        }
         free_command_list(&commands);
         output_writer_close(&output);
         logger_close(&logger);
         hash_table_destroy(&table);
+        if (record_pool_enabled) {
+            numa_pool_destroy(&record_pool);
+        }
+        numa_topology_destroy(&numa);
         return EXIT_FAILURE;
     }
 
+    HotCachePool hot_cache;
+    const char *hot_cache_option = getenv("CHASH_HOT_CACHE");
+    int hot_cache_enabled = hot_cache_option && strcmp(hot_cache_option, "0") != 0 && hot_cache_pool_init(&hot_cache) == 0;
+
+    SignalWatcher watcher;
+    int watcher_started = signal_watcher_start(&watcher, &table, hot_cache_enabled ? &hot_cache : NULL) == 0;
+    if (!watcher_started) {
+        fprintf(stderr, "SIGUSR1 statistics dump unavailable: failed to start watcher thread.\n");
+    }
+
     for (size_t i = 0; i < commands.size; ++i) {
         contexts[i].table = &table;
         contexts[i].logger = &logger;
         contexts[i].output = &output;
+        contexts[i].stats = stats_enabled ? &stats : NULL;
+        contexts[i].hot_cache = hot_cache_enabled ? &hot_cache : NULL;
         contexts[i].command = commands.items[i];
-        int rc = pthread_create(&threads[i], NULL, command_worker, &contexts[i]);
+        contexts[i].sequence = i;
+        int rc = create_command_thread(&numa, &threads[i], &contexts[i]);
         if (rc != 0) {
             fprintf(stderr, "Failed to create thread for command %zu, executing synchronously.\n", i);
             command_worker(&contexts[i]);
@@ -83,13 +242,30 @@ int main(void) {
             pthread_join(threads[i], NULL);
         }
     }
+    if (watcher_started) {
+        signal_watcher_stop(&watcher);
+    }
+    if (hot_cache_enabled) {
+        hot_cache_pool_destroy(&hot_cache);
+    }
+
+    if (stats_enabled) {
+        if (latency_stats_write_report(&stats, STATS_FILE) != 0) {
+            fprintf(stderr, "Failed to write latency statistics to %s\n", STATS_FILE);
+        }
+        latency_stats_destroy(&stats);
+    }
 
-    free(contexts);
+    free_contexts(&numa, contexts, commands.size);
     free(thread_created);
     free(threads);
     free_command_list(&commands);
     output_writer_close(&output);
     logger_close(&logger);
     hash_table_destroy(&table);
+    if (record_pool_enabled) {
+        numa_pool_destroy(&record_pool);
+    }
+    numa_topology_destroy(&numa);
     return EXIT_SUCCESS;
 }
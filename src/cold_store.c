@@ -0,0 +1,252 @@
+#include "cold_store.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "hash_table.h"
+
+typedef struct {
+    uint32_t hash;
+    uint32_t salary;
+    char name[HASH_NAME_MAX + 1];
+} ColdSlot;
+
+_Static_assert(sizeof(ColdSlot) <= COLD_SLOT_SIZE, "cold slot must fit COLD_SLOT_SIZE");
+
+static ColdSlot *slot_at(const ColdStore *store, uint32_t slot) {
+    return (ColdSlot *)(store->map + (size_t)slot * COLD_SLOT_SIZE);
+}
+
+// Extends the file and maps the larger range before dropping the old mapping.
+static int grow_slots(ColdStore *store) {
+    size_t capacity = store->slot_capacity ? store->slot_capacity * 2 : COLD_STORE_MIN_SLOTS;
+    if (capacity > COLD_SLOT_NONE) {
+        return -1;
+    }
+    size_t length = capacity * COLD_SLOT_SIZE;
+    if (ftruncate(store->fd, (off_t)length) != 0) {
+        return -1;
+    }
+    atomic_uchar *heat = (atomic_uchar *)realloc(store->heat, capacity * sizeof(atomic_uchar));
+    if (!heat) {
+        return -1;
+    }
+    store->heat = heat;
+    for (size_t i = store->slot_capacity; i < capacity; ++i) {
+        atomic_init(&heat[i], 0);
+    }
+    void *map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, store->fd, 0);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    // Lookups touch a single slot; read-ahead would only evict other pages.
+    posix_madvise(map, length, POSIX_MADV_RANDOM);
+    if (store->map) {
+        munmap(store->map, store->slot_capacity * COLD_SLOT_SIZE);
+    }
+    store->map = (unsigned char *)map;
+    store->slot_capacity = capacity;
+    return 0;
+}
+
+int cold_store_open(ColdStore *store, const char *directory) {
+    if (!store) {
+        return -1;
+    }
+    memset(store, 0, sizeof(*store));
+    if (!directory || directory[0] == '\0') {
+        directory = getenv("TMPDIR");
+    }
+    if (!directory || directory[0] == '\0') {
+        directory = "/tmp";
+    }
+    char path[4096];
+    if (snprintf(path, sizeof(path), "%s/chash-cold-XXXXXX", directory) >= (int)sizeof(path)) {
+        store->fd = -1;
+        return -1;
+    }
+    // mkstemp never reuses an existing file; the segment is scratch space for
+    // this process only, so it is unlinked straight away.
+    store->fd = mkstemp(path);
+    if (store->fd < 0) {
+        return -1;
+    }
+    unlink(path);
+    if (grow_slots(store) != 0) {
+        close(store->fd);
+        free(store->heat);
+        store->heat = NULL;
+        store->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void cold_store_close(ColdStore *store) {
+    if (!store) {
+        return;
+    }
+    if (store->map) {
+        munmap(store->map, store->slot_capacity * COLD_SLOT_SIZE);
+    }
+    if (store->fd >= 0) {
+        close(store->fd);
+    }
+    free(store->free_slots);
+    free(store->heat);
+    free(store->index);
+    memset(store, 0, sizeof(*store));
+    store->fd = -1;
+}
+
+int cold_store_write(ColdStore *store, uint32_t hash, const char *name, uint32_t salary, uint32_t *slot) {
+    if (!store || !store->map || !name || !slot) {
+        return -1;
+    }
+    if (store->free_count > 0) {
+        *slot = store->free_slots[--store->free_count];
+    } else {
+        if (store->slot_count == store->slot_capacity && grow_slots(store) != 0) {
+            return -1;
+        }
+        *slot = (uint32_t)store->slot_count++;
+    }
+    ColdSlot *target = slot_at(store, *slot);
+    atomic_store_explicit(&store->heat[*slot], 0, memory_order_relaxed);
+    target->hash = hash;
+    target->salary = salary;
+    strncpy(target->name, name, HASH_NAME_MAX);
+    target->name[HASH_NAME_MAX] = '\0';
+    return 0;
+}
+
+int cold_store_add_entries(ColdStore *store, const ColdIndexEntry *entries, size_t count) {
+    if (!store || (!entries && count > 0)) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    // Drop tombstones in place, then grow geometrically so a spill batch
+    // does not reallocate the whole index.
+    size_t kept = 0;
+    for (size_t i = 0; i < store->index_count; ++i) {
+        if (store->index[i].slot != COLD_SLOT_NONE) {
+            store->index[kept++] = store->index[i];
+        }
+    }
+    store->index_count = kept;
+    size_t needed = kept + count;
+    if (needed > store->index_capacity) {
+        size_t capacity = store->index_capacity ? store->index_capacity : COLD_STORE_MIN_SLOTS;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        ColdIndexEntry *grown = (ColdIndexEntry *)realloc(store->index, capacity * sizeof(ColdIndexEntry));
+        if (!grown) {
+            return -1;
+        }
+        store->index = grown;
+        store->index_capacity = capacity;
+    }
+    // Merge from the back; equal hashes keep existing entries first.
+    size_t i = kept;
+    size_t j = count;
+    size_t out = needed;
+    while (j > 0) {
+        if (i > 0 && store->index[i - 1].hash > entries[j - 1].hash) {
+            store->index[--out] = store->index[--i];
+        } else {
+            store->index[--out] = entries[--j];
+        }
+    }
+    store->index_count = needed;
+    store->live += count;
+    return 0;
+}
+
+size_t cold_store_find(const ColdStore *store, uint32_t hash, const char *name) {
+    if (!store || !name || store->live == 0) {
+        return COLD_STORE_NOT_FOUND;
+    }
+    size_t low = 0;
+    size_t high = store->index_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (store->index[middle].hash < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    for (size_t i = low; i < store->index_count && store->index[i].hash == hash; ++i) {
+        uint32_t slot = store->index[i].slot;
+        if (slot != COLD_SLOT_NONE && strncmp(slot_at(store, slot)->name, name, HASH_NAME_MAX) == 0) {
+            return i;
+        }
+    }
+    return COLD_STORE_NOT_FOUND;
+}
+
+void cold_store_read(const ColdStore *store, uint32_t slot, char *name, size_t name_size, uint32_t *salary) {
+    const ColdSlot *source = slot_at(store, slot);
+    if (name && name_size > 0) {
+        strncpy(name, source->name, name_size - 1);
+        name[name_size - 1] = '\0';
+    }
+    if (salary) {
+        *salary = source->salary;
+    }
+}
+
+void cold_store_remove(ColdStore *store, size_t position) {
+    if (!store || position >= store->index_count || store->index[position].slot == COLD_SLOT_NONE) {
+        return;
+    }
+    uint32_t slot = store->index[position].slot;
+    if (store->free_count == store->free_capacity) {
+        size_t capacity = store->free_capacity ? store->free_capacity * 2 : COLD_STORE_MIN_SLOTS;
+        uint32_t *grown = (uint32_t *)realloc(store->free_slots, capacity * sizeof(uint32_t));
+        if (grown) {
+            store->free_slots = grown;
+            store->free_capacity = capacity;
+        }
+    }
+    if (store->free_count < store->free_capacity) {
+        store->free_slots[store->free_count++] = slot;
+    }
+    store->index[position].slot = COLD_SLOT_NONE;
+    --store->live;
+
+    // Compact once tombstones dominate so lookups keep scanning few entries.
+    size_t tombstones = store->index_count - store->live;
+    if (tombstones >= COLD_STORE_MIN_SLOTS && tombstones > store->live) {
+        size_t out = 0;
+        for (size_t i = 0; i < store->index_count; ++i) {
+            if (store->index[i].slot != COLD_SLOT_NONE) {
+                store->index[out++] = store->index[i];
+            }
+        }
+        store->index_count = out;
+    }
+}
+
+int cold_store_note_read(ColdStore *store, uint32_t slot) {
+    atomic_uchar *heat = &store->heat[slot];
+    unsigned char value = atomic_load_explicit(heat, memory_order_relaxed);
+    if (value >= COLD_PROMOTE_READS) {
+        return 0; // already requested
+    }
+    return atomic_fetch_add_explicit(heat, 1, memory_order_relaxed) + 1u == COLD_PROMOTE_READS;
+}
+
+void cold_store_reset_heat(ColdStore *store, uint32_t slot) {
+    atomic_store_explicit(&store->heat[slot], 0, memory_order_relaxed);
+}
+
+size_t cold_store_file_bytes(const ColdStore *store) {
+    return store ? store->slot_capacity * COLD_SLOT_SIZE : 0;
+}
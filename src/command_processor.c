@@ -3,7 +3,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
+#include "record_format.h"
 #include "timestamp.h"
 
 static void log_waiting(CommandContext *ctx) {
@@ -42,34 +44,64 @@ static void log_write_released(CommandContext *ctx) {
     }
 }
 
+static void record_latency(CommandContext *ctx, LatencyMetric metric, uint64_t nanoseconds) {
+    if (ctx->stats) {
+        latency_recorder_add(&ctx->recorder, ctx->stats, metric, nanoseconds);
+    }
+}
+
 static void acquire_read_lock(CommandContext *ctx) {
     log_waiting(ctx);
-    pthread_rwlock_rdlock(&ctx->table->rwlock);
+    uint64_t wait_start = ctx->stats ? monotonic_nanoseconds() : 0;
+    int contended = pthread_rwlock_tryrdlock(&ctx->table->rwlock) != 0;
+    if (contended) {
+        pthread_rwlock_rdlock(&ctx->table->rwlock);
+    }
+    hash_table_count_lock(0, contended);
+    if (ctx->stats) {
+        ctx->lock_acquired_ns = monotonic_nanoseconds();
+        record_latency(ctx, LATENCY_READ_LOCK_WAIT, ctx->lock_acquired_ns - wait_start);
+    }
     log_awakened(ctx);
     log_read_acquired(ctx);
 }
 
 static void release_read_lock(CommandContext *ctx) {
     pthread_rwlock_unlock(&ctx->table->rwlock);
+    if (ctx->stats) {
+        record_latency(ctx, LATENCY_READ_LOCK_HOLD, monotonic_nanoseconds() - ctx->lock_acquired_ns);
+    }
     log_read_released(ctx);
 }
 
 static void acquire_write_lock(CommandContext *ctx) {
     log_waiting(ctx);
-    pthread_rwlock_wrlock(&ctx->table->rwlock);
+    uint64_t wait_start = ctx->stats ? monotonic_nanoseconds() : 0;
+    int contended = pthread_rwlock_trywrlock(&ctx->table->rwlock) != 0;
+    if (contended) {
+        pthread_rwlock_wrlock(&ctx->table->rwlock);
+    }
+    hash_table_count_lock(1, contended);
+    if (ctx->stats) {
+        ctx->lock_acquired_ns = monotonic_nanoseconds();
+        record_latency(ctx, LATENCY_WRITE_LOCK_WAIT, ctx->lock_acquired_ns - wait_start);
+    }
     log_awakened(ctx);
     log_write_acquired(ctx);
 }
 
 static void release_write_lock(CommandContext *ctx) {
     pthread_rwlock_unlock(&ctx->table->rwlock);
+    if (ctx->stats) {
+        record_latency(ctx, LATENCY_WRITE_LOCK_HOLD, monotonic_nanoseconds() - ctx->lock_acquired_ns);
+    }
     log_write_released(ctx);
 }
 
 static void process_insert(CommandContext *ctx) {
-    uint32_t hash = jenkins_one_at_a_time_hash(ctx->command.name);
+    uint32_t hash = ctx->command.hash;
     if (ctx->logger) {
-        logger_log_command(ctx->logger, ctx->command.priority, "INSERT,%u,%s,%u", hash, ctx->command.name, ctx->command.salary);
+        logger_log_insert(ctx->logger, ctx->command.priority, hash, ctx->command.name, ctx->command.salary);
     }
     acquire_write_lock(ctx);
     uint32_t previous_salary = 0;
@@ -81,53 +113,75 @@ static void process_insert(CommandContext *ctx) {
         return;
     }
     if (was_update) {
-        printf("Updated record %u from %u to %u\n", hash, previous_salary, ctx->command.salary);
+        output_block_appendf(&ctx->block, OUTPUT_TO_CONSOLE, "Updated record %u from %u to %u\n", hash, previous_salary, ctx->command.salary);
     } else {
-        printf("Inserted %s with hash %u salary %u\n", ctx->command.name, hash, ctx->command.salary);
+        output_block_appendf(&ctx->block, OUTPUT_TO_CONSOLE, "Inserted %s with hash %u salary %u\n", ctx->command.name, hash, ctx->command.salary);
     }
 }
 
 static void process_delete(CommandContext *ctx) {
-    uint32_t hash = jenkins_one_at_a_time_hash(ctx->command.name);
+    uint32_t hash = ctx->command.hash;
     if (ctx->logger) {
-        logger_log_command(ctx->logger, ctx->command.priority, "DELETE,%u,%s", hash, ctx->command.name);
+        logger_log_delete(ctx->logger, ctx->command.priority, hash, ctx->command.name);
+    }
+    int status = 0;
+    // A filter rejection proves the key is absent, so the write lock is never taken.
+    if (membership_filter_may_contain(&ctx->table->filter, hash, ctx->command.name)) {
+        acquire_write_lock(ctx);
+        uint32_t removed_salary = 0;
+        status = hash_table_delete_locked(ctx->table, ctx->command.name, hash, &removed_salary);
+        if (status != 1) {
+            membership_filter_note_false_positive(&ctx->table->filter);
+        }
+        release_write_lock(ctx);
     }
-    acquire_write_lock(ctx);
-    uint32_t removed_salary = 0;
-    int status = hash_table_delete_locked(ctx->table, ctx->command.name, hash, &removed_salary);
-    release_write_lock(ctx);
     if (status == 1) {
-        printf("Deleted record for %s (hash %u)\n", ctx->command.name, hash);
+        output_block_appendf(&ctx->block, OUTPUT_TO_CONSOLE, "Deleted record for %s (hash %u)\n", ctx->command.name, hash);
     } else {
-        printf("No record found for %s\n", ctx->command.name);
+        output_block_appendf(&ctx->block, OUTPUT_TO_CONSOLE, "No record found for %s\n", ctx->command.name);
     }
 }
 
 static void process_search(CommandContext *ctx) {
-    uint32_t hash = jenkins_one_at_a_time_hash(ctx->command.name);
+    uint32_t hash = ctx->command.hash;
     if (ctx->logger) {
-        logger_log_command(ctx->logger, ctx->command.priority, "SEARCH,%u,%s", hash, ctx->command.name);
+        logger_log_search(ctx->logger, ctx->command.priority, hash, ctx->command.name);
+    }
+    // Caches are only checked out around non-blocking work; holding one while
+    // waiting for the lock would force the pool to grow under contention.
+    HotKeyCache *cache = ctx->hot_cache ? hot_cache_pool_acquire(ctx->hot_cache) : NULL;
+    uint32_t cached_salary = 0;
+    int cache_hit = cache && hot_cache_lookup(cache, ctx->table, hash, ctx->command.name, &cached_salary);
+    hot_cache_pool_release(ctx->hot_cache, cache);
+    if (cache_hit) {
+        output_block_appendf(&ctx->block, OUTPUT_TO_BOTH, "Found: %u,%s,%u\n", hash, ctx->command.name, cached_salary);
+        return;
+    }
+    if (!membership_filter_may_contain(&ctx->table->filter, hash, ctx->command.name)) {
+        output_block_append(&ctx->block, OUTPUT_TO_CONSOLE, "No Record Found\n");
+        output_block_appendf(&ctx->block, OUTPUT_TO_FILE, "No Record Found for %s\n", ctx->command.name);
+        return;
     }
     acquire_read_lock(ctx);
-    hashRecord *record = hash_table_find(ctx->table, ctx->command.name);
+    hashRecord *record = hash_table_find(ctx->table, ctx->command.name, hash);
     hashRecord snapshot;
     int found = 0;
     if (record) {
         snapshot = *record;
         snapshot.next = NULL;
         found = 1;
+        cache = ctx->hot_cache ? hot_cache_pool_acquire(ctx->hot_cache) : NULL;
+        hot_cache_store(cache, ctx->table, hash, ctx->command.name, snapshot.salary);
+        hot_cache_pool_release(ctx->hot_cache, cache);
+    } else {
+        membership_filter_note_false_positive(&ctx->table->filter);
     }
     release_read_lock(ctx);
     if (found) {
-        printf("Found: %u,%s,%u\n", snapshot.hash, snapshot.name, snapshot.salary);
-        if (ctx->output) {
-            output_writer_appendf(ctx->output, "Found: %u,%s,%u\n", snapshot.hash, snapshot.name, snapshot.salary);
-        }
+        output_block_appendf(&ctx->block, OUTPUT_TO_BOTH, "Found: %u,%s,%u\n", snapshot.hash, snapshot.name, snapshot.salary);
     } else {
-        printf("No Record Found\n");
-        if (ctx->output) {
-            output_writer_appendf(ctx->output, "No Record Found for %s\n", ctx->command.name);
-        }
+        output_block_append(&ctx->block, OUTPUT_TO_CONSOLE, "No Record Found\n");
+        output_block_appendf(&ctx->block, OUTPUT_TO_FILE, "No Record Found for %s\n", ctx->command.name);
     }
 }
 
@@ -140,49 +194,111 @@ static void process_print(CommandContext *ctx) {
     hashRecord *records = hash_table_clone_records(ctx->table, &count);
     release_read_lock(ctx);
 
-    printf("Current Database:\n");
-    if (ctx->output) {
-        output_writer_append(ctx->output, "Current Database:\n");
-    }
-
+    output_block_append(&ctx->block, OUTPUT_TO_BOTH, "Current Database:\n");
     if (!records || count == 0) {
-        printf("(empty)\n");
-        if (ctx->output) {
-            output_writer_append(ctx->output, "(empty)\n");
-        }
+        output_block_append(&ctx->block, OUTPUT_TO_BOTH, "(empty)\n");
     } else {
-        for (size_t i = 0; i < count; ++i) {
-            printf("%u,%s,%u\n", records[i].hash, records[i].name, records[i].salary);
-            if (ctx->output) {
-                output_writer_appendf(ctx->output, "%u,%s,%u\n", records[i].hash, records[i].name, records[i].salary);
-            }
+        if (append_record_listing(&ctx->block, OUTPUT_TO_BOTH, records, count) != 0) {
+            fprintf(stderr, "Failed to format database listing\n");
         }
         free(records);
     }
 }
 
+static void process_stats(CommandContext *ctx) {
+    if (ctx->logger) {
+        logger_log_command(ctx->logger, ctx->command.priority, "STATS");
+    }
+    char buffer[TABLE_REPORT_MAX];
+    if (format_table_report(ctx->table, ctx->hot_cache, ctx, buffer, sizeof(buffer)) < 0) {
+        fprintf(stderr, "Failed to format table statistics\n");
+        return;
+    }
+    output_block_append(&ctx->block, OUTPUT_TO_BOTH, buffer);
+}
+
+int format_table_report(HashTable *table, HotCachePool *hot_cache, CommandContext *ctx, char *buffer, size_t size) {
+    if (!table || !buffer || size == 0) {
+        return -1;
+    }
+    // Publish this thread's counters first so they are part of the snapshot.
+    hash_table_flush_thread_counters(table);
+    HashTableStats stats;
+    if (ctx) {
+        acquire_read_lock(ctx);
+    } else {
+        pthread_rwlock_rdlock(&table->rwlock);
+    }
+    hash_table_collect_stats(table, &stats);
+    if (ctx) {
+        release_read_lock(ctx);
+    } else {
+        pthread_rwlock_unlock(&table->rwlock);
+    }
+
+    size_t length = (size_t)snprintf(buffer, size, "Table Statistics:\n");
+    int written = length < size ? hash_table_format_stats(&stats, buffer + length, size - length) : -1;
+    if (written < 0 || (size_t)written >= size - length) {
+        return -1;
+    }
+    length += (size_t)written;
+    if (hot_cache) {
+        HotCacheStats cache_stats;
+        hot_cache_pool_collect_stats(hot_cache, &cache_stats);
+        written = hot_cache_format_stats(&cache_stats, buffer + length, size - length);
+        if (written < 0 || (size_t)written >= size - length) {
+            return -1;
+        }
+        length += (size_t)written;
+    }
+    return (int)length;
+}
+
 void *command_worker(void *arg) {
     CommandContext *ctx = (CommandContext *)arg;
     if (!ctx || !ctx->table) {
         return NULL;
     }
+    output_block_init(&ctx->block);
+    uint64_t start = ctx->stats ? monotonic_nanoseconds() : 0;
+    LatencyMetric metric = LATENCY_METRIC_COUNT;
     switch (ctx->command.type) {
         case COMMAND_INSERT:
             process_insert(ctx);
+            metric = LATENCY_INSERT;
             break;
         case COMMAND_DELETE:
             process_delete(ctx);
+            metric = LATENCY_DELETE;
             break;
         case COMMAND_SEARCH:
             process_search(ctx);
+            metric = LATENCY_SEARCH;
             break;
         case COMMAND_PRINT:
             process_print(ctx);
+            metric = LATENCY_PRINT;
+            break;
+        case COMMAND_STATS:
+            process_stats(ctx);
+            metric = LATENCY_STATS;
             break;
         default:
             fprintf(stderr, "Unknown command type encountered\n");
             break;
     }
+    if (ctx->output) {
+        output_writer_commit(ctx->output, ctx->sequence, &ctx->block);
+    } else {
+        // No output file: the console transcript still goes out, unordered.
+        output_block_write(&ctx->block, STDOUT_FILENO, OUTPUT_TO_CONSOLE);
+        output_block_free(&ctx->block);
+    }
+    if (ctx->stats && metric != LATENCY_METRIC_COUNT) {
+        record_latency(ctx, metric, monotonic_nanoseconds() - start);
+    }
+    latency_recorder_flush(&ctx->recorder, ctx->stats);
+    hash_table_flush_thread_counters(ctx->table);
     return NULL;
 }
 
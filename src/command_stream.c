@@ -0,0 +1,282 @@
+#include "command_stream.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void set_error(char *error_message, size_t error_size, const char *format, const char *detail) {
+    if (error_message && error_size > 0) {
+        snprintf(error_message, error_size, format, detail);
+    }
+}
+
+static void put_u16(unsigned char *out, uint16_t value) {
+    out[0] = (unsigned char)(value & 0xFFu);
+    out[1] = (unsigned char)(value >> 8);
+}
+
+static void put_u32(unsigned char *out, uint32_t value) {
+    out[0] = (unsigned char)(value & 0xFFu);
+    out[1] = (unsigned char)((value >> 8) & 0xFFu);
+    out[2] = (unsigned char)((value >> 16) & 0xFFu);
+    out[3] = (unsigned char)(value >> 24);
+}
+
+static uint16_t get_u16(const unsigned char *in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t get_u32(const unsigned char *in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+// Bitwise CRC-32 (reflected, polynomial 0xEDB88320); the stream is checked
+// once per load, so a lookup table would not pay for itself.
+static uint32_t crc32_update(uint32_t crc, const unsigned char *data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static size_t put_varint(unsigned char *out, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80u) {
+        out[length++] = (unsigned char)(value | 0x80u);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+    return length;
+}
+
+static int get_varint(const unsigned char **cursor, const unsigned char *end, uint32_t *value) {
+    uint32_t result = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (*cursor >= end) {
+            return -1;
+        }
+        unsigned char byte = *(*cursor)++;
+        if (shift == 28 && (byte & 0xF0u) != 0) {
+            return -1; // would overflow 32 bits
+        }
+        result |= (uint32_t)(byte & 0x7Fu) << shift;
+        if ((byte & 0x80u) == 0) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int command_stream_is_binary(const char *path) {
+    // Probing a pipe would consume its first bytes; only regular files can be streams.
+    struct stat info;
+    if (!path || stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return 0;
+    }
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return 0;
+    }
+    char magic[4];
+    size_t read = fread(magic, 1, sizeof(magic), fp);
+    fclose(fp);
+    return read == sizeof(magic) && memcmp(magic, COMMAND_STREAM_MAGIC, sizeof(magic)) == 0;
+}
+
+int command_stream_write(const char *path, const CommandList *list, char *error_message, size_t error_size) {
+    if (!path || !list) {
+        set_error(error_message, error_size, "%s", "Invalid arguments");
+        return -1;
+    }
+    if (list->size > UINT32_MAX) {
+        set_error(error_message, error_size, "%s", "Too many commands");
+        return -1;
+    }
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        set_error(error_message, error_size, "Unable to open %s", path);
+        return -1;
+    }
+
+    unsigned char header[COMMAND_STREAM_HEADER_SIZE] = {0};
+    memcpy(header, COMMAND_STREAM_MAGIC, 4);
+    put_u16(header + 4, COMMAND_STREAM_VERSION);
+    put_u32(header + 8, (uint32_t)list->size);
+    int failed = fwrite(header, 1, sizeof(header), fp) != sizeof(header);
+
+    // type + 2 varints + hash + length + name
+    unsigned char record[1 + 5 + 5 + 4 + 1 + HASH_NAME_MAX];
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < list->size && !failed; ++i) {
+        const Command *command = &list->items[i];
+        size_t length = 0;
+        record[length++] = (unsigned char)command->type;
+        length += put_varint(record + length, command->priority);
+        if (command->type == COMMAND_INSERT) {
+            length += put_varint(record + length, command->salary);
+        }
+        if (command_type_has_name(command->type)) {
+            size_t name_length = strnlen(command->name, HASH_NAME_MAX);
+            put_u32(record + length, command->hash);
+            length += 4;
+            record[length++] = (unsigned char)name_length;
+            memcpy(record + length, command->name, name_length);
+            length += name_length;
+        }
+        failed = fwrite(record, 1, length, fp) != length;
+        checksum = crc32_update(checksum, record, length);
+    }
+    if (!failed) {
+        put_u32(header + 12, checksum);
+        failed = fseek(fp, 0, SEEK_SET) != 0 || fwrite(header, 1, sizeof(header), fp) != sizeof(header);
+    }
+
+    if (fclose(fp) != 0) {
+        failed = 1;
+    }
+    if (failed) {
+        set_error(error_message, error_size, "Failed writing %s", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int decode_records(const unsigned char *cursor, const unsigned char *end, CommandList *list,
+                          char *error_message, size_t error_size) {
+    char detail[64];
+    for (size_t i = 0; i < list->capacity; ++i) {
+        Command *command = &list->items[i];
+        snprintf(detail, sizeof(detail), "%zu", i);
+        if (cursor >= end) {
+            set_error(error_message, error_size, "Record %s: truncated stream", detail);
+            return -1;
+        }
+        unsigned char type = *cursor++;
+        if (type > COMMAND_STATS) {
+            set_error(error_message, error_size, "Record %s: unknown command type", detail);
+            return -1;
+        }
+        command->type = (CommandType)type;
+        command->salary = 0;
+        command->hash = 0;
+        command->name[0] = '\0';
+        if (get_varint(&cursor, end, &command->priority) != 0) {
+            set_error(error_message, error_size, "Record %s: invalid priority", detail);
+            return -1;
+        }
+        if (command->type == COMMAND_INSERT && get_varint(&cursor, end, &command->salary) != 0) {
+            set_error(error_message, error_size, "Record %s: invalid salary", detail);
+            return -1;
+        }
+        if (command_type_has_name(command->type)) {
+            if (end - cursor < 5) {
+                set_error(error_message, error_size, "Record %s: truncated stream", detail);
+                return -1;
+            }
+            command->hash = get_u32(cursor);
+            size_t name_length = cursor[4];
+            cursor += 5;
+            if (name_length > HASH_NAME_MAX || (size_t)(end - cursor) < name_length) {
+                set_error(error_message, error_size, "Record %s: invalid name length", detail);
+                return -1;
+            }
+            memcpy(command->name, cursor, name_length);
+            command->name[name_length] = '\0';
+            cursor += name_length;
+        }
+        list->size = i + 1;
+    }
+    if (cursor != end) {
+        set_error(error_message, error_size, "%s", "Trailing bytes after the last record");
+        return -1;
+    }
+    return 0;
+}
+
+int command_stream_load(const char *path, CommandList *list, char *error_message, size_t error_size) {
+    if (!path || !list) {
+        set_error(error_message, error_size, "%s", "Invalid arguments");
+        return -1;
+    }
+    list->items = NULL;
+    list->size = 0;
+    list->capacity = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        set_error(error_message, error_size, "Unable to open %s", path);
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < COMMAND_STREAM_HEADER_SIZE) {
+        close(fd);
+        set_error(error_message, error_size, "%s is not a command stream", path);
+        return -1;
+    }
+    size_t length = (size_t)info.st_size;
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        set_error(error_message, error_size, "Unable to map %s", path);
+        return -1;
+    }
+    posix_madvise(mapping, length, POSIX_MADV_SEQUENTIAL);
+
+    const unsigned char *data = (const unsigned char *)mapping;
+    int status = 0;
+    if (memcmp(data, COMMAND_STREAM_MAGIC, 4) != 0) {
+        set_error(error_message, error_size, "%s is not a command stream", path);
+        status = -1;
+    } else if (get_u16(data + 4) != COMMAND_STREAM_VERSION) {
+        set_error(error_message, error_size, "Unsupported command stream version in %s", path);
+        status = -1;
+    }
+
+    // The stored hashes are trusted from here on; a corrupt one would file its
+    // record under the wrong chain position, so check the whole stream first.
+    if (status == 0 && crc32_update(0, data + COMMAND_STREAM_HEADER_SIZE, length - COMMAND_STREAM_HEADER_SIZE) !=
+                           get_u32(data + 12)) {
+        set_error(error_message, error_size, "Checksum mismatch in %s", path);
+        status = -1;
+    }
+
+    uint32_t record_count = status == 0 ? get_u32(data + 8) : 0;
+    if (status == 0 && record_count == 0 && length != COMMAND_STREAM_HEADER_SIZE) {
+        set_error(error_message, error_size, "Trailing bytes after the header in %s", path);
+        status = -1;
+    } else if (record_count > 0) {
+        // Every record occupies at least two bytes; reject counts the file cannot hold.
+        if (record_count > (length - COMMAND_STREAM_HEADER_SIZE) / 2) {
+            set_error(error_message, error_size, "Record count in %s exceeds file size", path);
+            status = -1;
+        } else {
+            list->items = (Command *)malloc(record_count * sizeof(Command));
+            if (!list->items) {
+                set_error(error_message, error_size, "%s", "Out of memory");
+                status = -1;
+            } else {
+                list->capacity = record_count;
+                status = decode_records(data + COMMAND_STREAM_HEADER_SIZE, data + length, list,
+                                        error_message, error_size);
+            }
+        }
+    }
+
+    munmap(mapping, length);
+    if (status != 0) {
+        free(list->items);
+        list->items = NULL;
+        list->size = 0;
+        list->capacity = 0;
+    }
+    return status;
+}
@@ -2,9 +2,18 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Files smaller than this per available core are parsed on the calling thread.
+#define PARSE_CHUNK_MIN_BYTES (256u * 1024u)
+#define PARSE_MAX_CHUNKS 64
 
 static void trim_whitespace(char *text) {
     if (!text) {
@@ -58,13 +67,16 @@ static int parse_unsigned(const char *token, uint32_t *value) {
     return 0;
 }
 
-static int parse_line(const char *raw_line, Command *command, char *error_message, size_t error_size) {
+static int parse_line(const char *raw_line, size_t length, Command *command, char *error_message, size_t error_size) {
     if (!raw_line || !command) {
         return -1;
     }
     char buffer[256];
-    strncpy(buffer, raw_line, sizeof(buffer) - 1);
-    buffer[sizeof(buffer) - 1] = '\0';
+    if (length > sizeof(buffer) - 1) {
+        length = sizeof(buffer) - 1;
+    }
+    memcpy(buffer, raw_line, length);
+    buffer[length] = '\0';
     trim_whitespace(buffer);
     if (buffer[0] == '\0' || buffer[0] == '#') {
         return 1; // skip empty/comment
@@ -113,6 +125,7 @@ static int parse_line(const char *raw_line, Command *command, char *error_messag
         command->type = COMMAND_INSERT;
         strncpy(command->name, tokens[1], HASH_NAME_MAX);
         command->name[HASH_NAME_MAX] = '\0';
+        command->hash = jenkins_one_at_a_time_hash(command->name);
         command->salary = salary;
         command->priority = priority;
         return 0;
@@ -135,6 +148,7 @@ static int parse_line(const char *raw_line, Command *command, char *error_messag
         command->type = COMMAND_DELETE;
         strncpy(command->name, tokens[1], HASH_NAME_MAX);
         command->name[HASH_NAME_MAX] = '\0';
+        command->hash = jenkins_one_at_a_time_hash(command->name);
         command->salary = 0;
         command->priority = priority;
         return 0;
@@ -157,6 +171,7 @@ static int parse_line(const char *raw_line, Command *command, char *error_messag
         command->type = COMMAND_SEARCH;
         strncpy(command->name, tokens[1], HASH_NAME_MAX);
         command->name[HASH_NAME_MAX] = '\0';
+        command->hash = jenkins_one_at_a_time_hash(command->name);
         command->salary = 0;
         command->priority = priority;
         return 0;
@@ -176,6 +191,25 @@ static int parse_line(const char *raw_line, Command *command, char *error_messag
         command->name[0] = '\0';
         command->salary = 0;
         command->priority = priority;
+        command->hash = 0;
+        return 0;
+    }
+
+    if (strcmp(command_token, "STATS") == 0) {
+        if (token_count < 2) {
+            snprintf(error_message, error_size, "STATS expects 2 tokens");
+            return -1;
+        }
+        uint32_t priority;
+        if (parse_unsigned(tokens[1], &priority) != 0) {
+            snprintf(error_message, error_size, "Invalid priority value");
+            return -1;
+        }
+        command->type = COMMAND_STATS;
+        command->name[0] = '\0';
+        command->salary = 0;
+        command->priority = priority;
+        command->hash = 0;
         return 0;
     }
 
@@ -183,39 +217,133 @@ static int parse_line(const char *raw_line, Command *command, char *error_messag
     return -1;
 }
 
-int load_commands(const char *path, CommandList *list, char *error_message, size_t error_size) {
-    if (!path || !list) {
-        if (error_message && error_size > 0) {
-            snprintf(error_message, error_size, "Invalid arguments");
+typedef struct {
+    const char *begin;
+    const char *end;
+    CommandList commands;
+    size_t line_count;
+    int status;
+    char error[128];
+} ParseChunk;
+
+static void *parse_chunk(void *arg) {
+    ParseChunk *chunk = (ParseChunk *)arg;
+    const char *cursor = chunk->begin;
+    while (cursor < chunk->end) {
+        const char *newline = memchr(cursor, '\n', (size_t)(chunk->end - cursor));
+        const char *line_end = newline ? newline : chunk->end;
+        ++chunk->line_count;
+        Command command;
+        char parse_error[96] = {0};
+        int result = parse_line(cursor, (size_t)(line_end - cursor), &command, parse_error, sizeof(parse_error));
+        if (result < 0) {
+            snprintf(chunk->error, sizeof(chunk->error), "%s", parse_error);
+            chunk->status = -1;
+            return NULL;
         }
-        return -1;
+        if (result == 0) {
+            if (ensure_capacity(&chunk->commands, chunk->commands.size + 1) != 0) {
+                snprintf(chunk->error, sizeof(chunk->error), "Out of memory");
+                chunk->status = -2;
+                return NULL;
+            }
+            chunk->commands.items[chunk->commands.size++] = command;
+        }
+        cursor = line_end + 1;
+    }
+    return NULL;
+}
+
+static size_t choose_chunk_count(size_t length) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t count = length / PARSE_CHUNK_MIN_BYTES;
+    if (cpus > 0 && count > (size_t)cpus) {
+        count = (size_t)cpus;
+    }
+    if (count > PARSE_MAX_CHUNKS) {
+        count = PARSE_MAX_CHUNKS;
+    }
+    return count ? count : 1;
+}
+
+// Splits [data, data + length) into chunks that each start at the beginning of a line.
+static size_t split_chunks(const char *data, size_t length, ParseChunk *chunks, size_t chunk_count) {
+    const char *end = data + length;
+    const char *cursor = data;
+    size_t used = 0;
+    for (size_t i = 0; i < chunk_count && cursor < end; ++i) {
+        const char *chunk_end = end;
+        if (i + 1 < chunk_count) {
+            const char *target = data + (length / chunk_count) * (i + 1);
+            if (target < cursor) {
+                target = cursor;
+            }
+            const char *newline = memchr(target, '\n', (size_t)(end - target));
+            chunk_end = newline ? newline + 1 : end;
+        }
+        memset(&chunks[used], 0, sizeof(ParseChunk));
+        chunks[used].begin = cursor;
+        chunks[used].end = chunk_end;
+        ++used;
+        cursor = chunk_end;
     }
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
+    return used;
+}
+
+static int collect_chunks(ParseChunk *chunks, size_t chunk_count, CommandList *list,
+                          char *error_message, size_t error_size) {
+    size_t lines_before = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        if (chunks[i].status == -1) {
+            if (error_message && error_size > 0) {
+                snprintf(error_message, error_size, "Line %zu: %s", lines_before + chunks[i].line_count, chunks[i].error);
+            }
+            return -1;
+        }
+        if (chunks[i].status != 0) {
+            if (error_message && error_size > 0) {
+                snprintf(error_message, error_size, "%s", chunks[i].error);
+            }
+            return -1;
+        }
+        lines_before += chunks[i].line_count;
+        total += chunks[i].commands.size;
+    }
+    if (chunk_count == 1) {
+        *list = chunks[0].commands;
+        chunks[0].commands.items = NULL;
+        return 0;
+    }
+    if (ensure_capacity(list, total) != 0) {
         if (error_message && error_size > 0) {
-            snprintf(error_message, error_size, "Unable to open %s", path);
+            snprintf(error_message, error_size, "Out of memory");
         }
         return -1;
     }
-    list->items = NULL;
-    list->size = 0;
-    list->capacity = 0;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        if (chunks[i].commands.size > 0) {
+            memcpy(list->items + list->size, chunks[i].commands.items, chunks[i].commands.size * sizeof(Command));
+            list->size += chunks[i].commands.size;
+        }
+    }
+    return 0;
+}
+
+// Line-at-a-time reader for pipes, FIFOs and terminals, which cannot be mapped.
+static int load_commands_sequential(FILE *fp, CommandList *list, char *error_message, size_t error_size) {
     char line[256];
     size_t line_number = 0;
     while (fgets(line, sizeof(line), fp)) {
         ++line_number;
+        size_t length = strcspn(line, "\n");
         Command command;
-        char parse_error[128] = {0};
-        int result = parse_line(line, &command, parse_error, sizeof(parse_error));
+        char parse_error[96] = {0};
+        int result = parse_line(line, length, &command, parse_error, sizeof(parse_error));
         if (result < 0) {
             if (error_message && error_size > 0) {
                 snprintf(error_message, error_size, "Line %zu: %s", line_number, parse_error);
             }
-            fclose(fp);
-            free(list->items);
-            list->items = NULL;
-            list->size = 0;
-            list->capacity = 0;
             return -1;
         }
         if (result > 0) {
@@ -225,19 +353,115 @@ int load_commands(const char *path, CommandList *list, char *error_message, size
             if (error_message && error_size > 0) {
                 snprintf(error_message, error_size, "Out of memory");
             }
-            fclose(fp);
-            free(list->items);
-            list->items = NULL;
-            list->size = 0;
-            list->capacity = 0;
             return -1;
         }
         list->items[list->size++] = command;
     }
-    fclose(fp);
+    if (ferror(fp)) {
+        if (error_message && error_size > 0) {
+            snprintf(error_message, error_size, "Read error");
+        }
+        return -1;
+    }
     return 0;
 }
 
+int load_commands(const char *path, CommandList *list, char *error_message, size_t error_size) {
+    return load_commands_chunked(path, list, 0, error_message, error_size);
+}
+
+int load_commands_chunked(const char *path, CommandList *list, size_t chunk_count,
+                          char *error_message, size_t error_size) {
+    if (!path || !list) {
+        if (error_message && error_size > 0) {
+            snprintf(error_message, error_size, "Invalid arguments");
+        }
+        return -1;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (error_message && error_size > 0) {
+            snprintf(error_message, error_size, "Unable to open %s", path);
+        }
+        return -1;
+    }
+    list->items = NULL;
+    list->size = 0;
+    list->capacity = 0;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        if (error_message && error_size > 0) {
+            snprintf(error_message, error_size, "Unable to stat %s", path);
+        }
+        return -1;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        FILE *fp = fdopen(fd, "r");
+        if (!fp) {
+            close(fd);
+            if (error_message && error_size > 0) {
+                snprintf(error_message, error_size, "Unable to open %s", path);
+            }
+            return -1;
+        }
+        int status = load_commands_sequential(fp, list, error_message, error_size);
+        fclose(fp);
+        if (status != 0) {
+            free_command_list(list);
+        }
+        return status;
+    }
+    size_t length = (size_t)info.st_size;
+    if (length == 0) {
+        close(fd);
+        return 0;
+    }
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        if (error_message && error_size > 0) {
+            snprintf(error_message, error_size, "Unable to map %s", path);
+        }
+        return -1;
+    }
+
+    ParseChunk chunks[PARSE_MAX_CHUNKS];
+    pthread_t threads[PARSE_MAX_CHUNKS];
+    int thread_created[PARSE_MAX_CHUNKS] = {0};
+    if (chunk_count == 0) {
+        chunk_count = choose_chunk_count(length);
+    } else if (chunk_count > PARSE_MAX_CHUNKS) {
+        chunk_count = PARSE_MAX_CHUNKS;
+    }
+    chunk_count = split_chunks((const char *)mapping, length, chunks, chunk_count);
+    for (size_t i = 1; i < chunk_count; ++i) {
+        thread_created[i] = pthread_create(&threads[i], NULL, parse_chunk, &chunks[i]) == 0;
+        if (!thread_created[i]) {
+            parse_chunk(&chunks[i]);
+        }
+    }
+    parse_chunk(&chunks[0]);
+    for (size_t i = 1; i < chunk_count; ++i) {
+        if (thread_created[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    munmap(mapping, length);
+
+    int status = collect_chunks(chunks, chunk_count, list, error_message, error_size);
+    for (size_t i = 0; i < chunk_count; ++i) {
+        free(chunks[i].commands.items);
+    }
+    if (status != 0) {
+        free(list->items);
+        list->items = NULL;
+        list->size = 0;
+        list->capacity = 0;
+    }
+    return status;
+}
+
 void free_command_list(CommandList *list) {
     if (!list) {
         return;
@@ -258,8 +482,14 @@ const char *command_type_to_string(CommandType type) {
             return "SEARCH";
         case COMMAND_PRINT:
             return "PRINT";
+        case COMMAND_STATS:
+            return "STATS";
         default:
             return "UNKNOWN";
     }
 }
 
+int command_type_has_name(CommandType type) {
+    return type == COMMAND_INSERT || type == COMMAND_DELETE || type == COMMAND_SEARCH;
+}
+
@@ -1,14 +1,96 @@
 #include "hash_table.h"
 
+#include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+typedef struct {
+    uint64_t lookups;
+    uint64_t inserts;
+    uint64_t updates;
+    uint64_t deletes;
+    uint64_t delete_misses;
+    uint64_t probes;
+    uint64_t max_probe;
+    uint64_t read_locks;
+    uint64_t write_locks;
+    uint64_t contended_locks;
+} ThreadCounters;
+
+static _Thread_local ThreadCounters thread_counters;
+static _Thread_local hashRecord cold_result;
+
+// Record storage is only touched under the write lock (or at init/destroy).
+static hashRecord *allocate_record(HashTable *table, uint32_t hash) {
+    if (table->record_pool) {
+        size_t node = numa_node_for_hash(table->record_pool->topology, hash);
+        return (hashRecord *)numa_pool_alloc(table->record_pool, node);
+    }
+    return (hashRecord *)calloc(1, sizeof(hashRecord));
+}
+
+static void release_record(HashTable *table, hashRecord *record) {
+    if (table->record_pool) {
+        numa_pool_free(table->record_pool, record);
+    } else {
+        free(record);
+    }
+}
+
+static void count_probes(uint64_t probes) {
+    thread_counters.probes += probes;
+    if (probes > thread_counters.max_probe) {
+        thread_counters.max_probe = probes;
+    }
+}
+
 void hash_table_init(HashTable *table) {
     if (!table) {
         return;
     }
     table->head = NULL;
+    table->record_count = 0;
+    table->memory_cap = 0;
+    table->resident_count = 0;
+    memset(&table->cold, 0, sizeof(table->cold));
+    table->cold.fd = -1;
+    atomic_init(&table->access_epoch, 0);
+    table->writes_this_epoch = 0;
+    pthread_mutex_init(&table->promotion_mutex, NULL);
+    table->promotion_count = 0;
+    table->evictions = 0;
+    table->promotions = 0;
+    table->cap_exceeded = 0;
+    table->record_pool = NULL;
     pthread_rwlock_init(&table->rwlock, NULL);
+    membership_filter_init(&table->filter, 0);
+    HashTableCounters *counters = &table->counters;
+    atomic_init(&counters->lookups, 0);
+    atomic_init(&counters->inserts, 0);
+    atomic_init(&counters->updates, 0);
+    atomic_init(&counters->deletes, 0);
+    atomic_init(&counters->delete_misses, 0);
+    atomic_init(&counters->probes, 0);
+    atomic_init(&counters->max_probe, 0);
+    atomic_init(&counters->read_locks, 0);
+    atomic_init(&counters->write_locks, 0);
+    atomic_init(&counters->contended_locks, 0);
+    for (size_t i = 0; i < HASH_TABLE_VERSION_STRIPES; ++i) {
+        atomic_init(&table->versions[i], 0);
+    }
+}
+
+static void bump_version(HashTable *table, uint32_t hash) {
+    atomic_fetch_add_explicit(&table->versions[hash % HASH_TABLE_VERSION_STRIPES], 1, memory_order_release);
+}
+
+uint64_t hash_table_version(HashTable *table, uint32_t hash) {
+    return atomic_load_explicit(&table->versions[hash % HASH_TABLE_VERSION_STRIPES], memory_order_acquire);
+}
+
+unsigned hash_table_access_epoch(HashTable *table) {
+    return atomic_load_explicit(&table->access_epoch, memory_order_relaxed);
 }
 
 void hash_table_destroy(HashTable *table) {
@@ -19,12 +101,303 @@ void hash_table_destroy(HashTable *table) {
     hashRecord *current = table->head;
     while (current) {
         hashRecord *next = current->next;
-        free(current);
+        release_record(table, current);
         current = next;
     }
     table->head = NULL;
+    table->record_count = 0;
+    table->resident_count = 0;
+    if (table->memory_cap) {
+        cold_store_close(&table->cold);
+        table->memory_cap = 0;
+    }
     pthread_rwlock_unlock(&table->rwlock);
     pthread_rwlock_destroy(&table->rwlock);
+    pthread_mutex_destroy(&table->promotion_mutex);
+    membership_filter_destroy(&table->filter);
+}
+
+int hash_table_enable_tiering(HashTable *table, size_t memory_cap, const char *directory) {
+    if (!table) {
+        return -1;
+    }
+    if (memory_cap == 0) {
+        return 0;
+    }
+    if (memory_cap < hash_table_min_memory_cap()) {
+        return -1;
+    }
+    if (cold_store_open(&table->cold, directory) != 0) {
+        return -1;
+    }
+    table->memory_cap = memory_cap;
+    return 0;
+}
+
+int hash_table_parse_memory_cap(const char *text, size_t *memory_cap) {
+    if (!text || !memory_cap || text[0] < '0' || text[0] > '9') {
+        return -1;
+    }
+    char *end = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (errno != 0 || value > SIZE_MAX) {
+        return -1;
+    }
+    unsigned shift = 0;
+    switch (*end) {
+        case 'k':
+        case 'K':
+            shift = 10;
+            ++end;
+            break;
+        case 'm':
+        case 'M':
+            shift = 20;
+            ++end;
+            break;
+        case 'g':
+        case 'G':
+            shift = 30;
+            ++end;
+            break;
+        default:
+            break;
+    }
+    if (*end != '\0' || value > (SIZE_MAX >> shift)) {
+        return -1;
+    }
+    *memory_cap = (size_t)value << shift;
+    return 0;
+}
+
+// Room for the minimum resident set plus the first cold index allocation.
+size_t hash_table_min_memory_cap(void) {
+    return HASH_TABLE_MIN_RESIDENT * sizeof(hashRecord) + COLD_STORE_MIN_SLOTS * sizeof(ColdIndexEntry);
+}
+
+static void touch_record(HashTable *table, hashRecord *record) {
+    if (!table->memory_cap) {
+        return;
+    }
+    unsigned epoch = atomic_load_explicit(&table->access_epoch, memory_order_relaxed);
+    // Skip the store when already current so hot records do not bounce cache lines.
+    if (atomic_load_explicit(&record->last_access, memory_order_relaxed) != epoch) {
+        atomic_store_explicit(&record->last_access, epoch, memory_order_relaxed);
+    }
+}
+
+static unsigned record_age(hashRecord *record, unsigned epoch) {
+    unsigned age = epoch - atomic_load_explicit(&record->last_access, memory_order_relaxed);
+    return age < HASH_TABLE_AGE_BUCKETS ? age : HASH_TABLE_AGE_BUCKETS - 1;
+}
+
+static size_t resident_bytes(const HashTable *table) {
+    return table->resident_count * sizeof(hashRecord) + table->cold.index_capacity * sizeof(ColdIndexEntry);
+}
+
+// Picks all records older than `threshold` and the first `*at_threshold` of that age.
+static int should_spill(unsigned age, unsigned threshold, size_t *at_threshold) {
+    if (age > threshold) {
+        return 1;
+    }
+    if (age == threshold && *at_threshold > 0) {
+        --*at_threshold;
+        return 1;
+    }
+    return 0;
+}
+
+// Spills the least recently used resident records until resident memory is
+// back under 7/8 of the cap; caller holds the write lock.
+static void evict_cold_records(HashTable *table) {
+    size_t index_bytes = table->cold.index_capacity * sizeof(ColdIndexEntry);
+    if (index_bytes + HASH_TABLE_MIN_RESIDENT * sizeof(hashRecord) > table->memory_cap) {
+        // Spilling more would only thrash records between the tiers.
+        if (!table->cap_exceeded) {
+            table->cap_exceeded = 1;
+            fprintf(stderr, "Memory cap of %zu bytes cannot hold the cold index; keeping records resident\n",
+                    table->memory_cap);
+        }
+        return;
+    }
+    size_t resident = resident_bytes(table);
+    size_t target = table->memory_cap - table->memory_cap / 8;
+    size_t saved = sizeof(hashRecord) - sizeof(ColdIndexEntry);
+    size_t wanted = (resident - target + saved - 1) / saved;
+    if (table->resident_count <= HASH_TABLE_MIN_RESIDENT) {
+        return;
+    }
+    if (wanted > table->resident_count - HASH_TABLE_MIN_RESIDENT) {
+        wanted = table->resident_count - HASH_TABLE_MIN_RESIDENT;
+    }
+    if (wanted == 0) {
+        return;
+    }
+
+    // Age histogram: spill whole age buckets, oldest first.
+    unsigned epoch = atomic_load_explicit(&table->access_epoch, memory_order_relaxed);
+    size_t ages[HASH_TABLE_AGE_BUCKETS] = {0};
+    for (hashRecord *node = table->head; node; node = node->next) {
+        ++ages[record_age(node, epoch)];
+    }
+    unsigned threshold = HASH_TABLE_AGE_BUCKETS - 1;
+    size_t older = 0;
+    while (threshold > 0 && older + ages[threshold] < wanted) {
+        older += ages[threshold--];
+    }
+
+    ColdIndexEntry *batch = (ColdIndexEntry *)malloc(wanted * sizeof(ColdIndexEntry));
+    if (!batch) {
+        return;
+    }
+    // Copy to the segment first; nodes are only unlinked once the index accepted them.
+    size_t at_threshold = wanted - older;
+    size_t spilled = 0;
+    for (hashRecord *node = table->head; node && spilled < wanted; node = node->next) {
+        if (!should_spill(record_age(node, epoch), threshold, &at_threshold)) {
+            continue;
+        }
+        if (cold_store_write(&table->cold, node->hash, node->name, node->salary, &batch[spilled].slot) != 0) {
+            break;
+        }
+        batch[spilled++].hash = node->hash;
+    }
+    int merged = spilled > 0 && cold_store_add_entries(&table->cold, batch, spilled) == 0;
+    free(batch);
+    if (!merged) {
+        return;
+    }
+
+    at_threshold = wanted - older;
+    size_t unlinked = 0;
+    hashRecord *prev = NULL;
+    hashRecord *node = table->head;
+    while (node && unlinked < spilled) {
+        hashRecord *next = node->next;
+        if (should_spill(record_age(node, epoch), threshold, &at_threshold)) {
+            if (prev) {
+                prev->next = next;
+            } else {
+                table->head = next;
+            }
+            release_record(table, node);
+            ++unlinked;
+        } else {
+            prev = node;
+        }
+        node = next;
+    }
+    table->resident_count -= unlinked;
+    table->evictions += unlinked;
+    atomic_fetch_add_explicit(&table->access_epoch, 1, memory_order_relaxed);
+}
+
+// Advances recency every HASH_TABLE_EPOCH_WRITES writes so records age before
+// the first eviction pass too; caller holds the write lock.
+static void advance_epoch(HashTable *table) {
+    if (table->memory_cap && ++table->writes_this_epoch >= HASH_TABLE_EPOCH_WRITES) {
+        table->writes_this_epoch = 0;
+        atomic_fetch_add_explicit(&table->access_epoch, 1, memory_order_relaxed);
+    }
+}
+
+// Called by readers (read lock held) when a spilled record is read repeatedly.
+static void request_promotion(HashTable *table, uint32_t hash, const char *name, uint32_t slot) {
+    pthread_mutex_lock(&table->promotion_mutex);
+    if (table->promotion_count < HASH_TABLE_PROMOTION_QUEUE) {
+        PromotionRequest *request = &table->promotion_queue[table->promotion_count++];
+        size_t length = strnlen(name, HASH_NAME_MAX);
+        request->hash = hash;
+        memcpy(request->name, name, length);
+        request->name[length] = '\0';
+    } else {
+        cold_store_reset_heat(&table->cold, slot); // let a later read ask again
+    }
+    pthread_mutex_unlock(&table->promotion_mutex);
+}
+
+// Moves the record at a cold index position back onto the chain.
+static void promote_cold_record(HashTable *table, size_t position) {
+    const ColdIndexEntry *entry = &table->cold.index[position];
+    hashRecord *node = allocate_record(table, entry->hash);
+    if (!node) {
+        return;
+    }
+    node->hash = entry->hash;
+    cold_store_read(&table->cold, entry->slot, node->name, sizeof(node->name), &node->salary);
+    atomic_init(&node->last_access, atomic_load_explicit(&table->access_epoch, memory_order_relaxed));
+    hashRecord *prev = NULL;
+    hashRecord *current = table->head;
+    while (current && current->hash <= node->hash) {
+        prev = current;
+        current = current->next;
+    }
+    node->next = current;
+    if (prev) {
+        prev->next = node;
+    } else {
+        table->head = node;
+    }
+    cold_store_remove(&table->cold, position);
+    ++table->resident_count;
+    ++table->promotions;
+}
+
+// Applies promotions queued by readers; caller holds the write lock.
+static void apply_promotions(HashTable *table) {
+    if (!table->memory_cap) {
+        return;
+    }
+    PromotionRequest requests[HASH_TABLE_PROMOTION_QUEUE];
+    pthread_mutex_lock(&table->promotion_mutex);
+    size_t count = table->promotion_count;
+    memcpy(requests, table->promotion_queue, count * sizeof(PromotionRequest));
+    table->promotion_count = 0;
+    pthread_mutex_unlock(&table->promotion_mutex);
+    for (size_t i = 0; i < count; ++i) {
+        size_t position = cold_store_find(&table->cold, requests[i].hash, requests[i].name);
+        if (position != COLD_STORE_NOT_FOUND) {
+            promote_cold_record(table, position);
+        }
+    }
+}
+
+// Rebuilds the membership filter from the live records for `reason` (a
+// FILTER_REBUILD_* value); caller holds the write lock.
+static void rebuild_filter(HashTable *table, int reason) {
+    FilterTable *rebuilt = membership_filter_rebuild_table(&table->filter, table->record_count, reason);
+    if (!rebuilt) {
+        return;
+    }
+    for (hashRecord *node = table->head; node; node = node->next) {
+        filter_table_add(rebuilt, node->hash, node->name);
+    }
+    for (size_t i = 0; i < table->cold.index_count; ++i) {
+        const ColdIndexEntry *entry = &table->cold.index[i];
+        if (entry->slot != COLD_SLOT_NONE) {
+            char name[HASH_NAME_MAX + 1];
+            cold_store_read(&table->cold, entry->slot, name, sizeof(name), NULL);
+            filter_table_add(rebuilt, entry->hash, name);
+        }
+    }
+    membership_filter_publish(&table->filter, rebuilt);
+}
+
+void hash_table_set_record_pool(HashTable *table, NumaObjectPool *pool) {
+    if (table && !table->head) {
+        table->record_pool = pool;
+    }
+}
+
+void hash_table_set_filter_enabled(HashTable *table, int enabled) {
+    if (!table) {
+        return;
+    }
+    membership_filter_set_enabled(&table->filter, enabled);
+    if (enabled) {
+        rebuild_filter(table, FILTER_REBUILD_RESIZE);
+    }
 }
 
 uint32_t jenkins_one_at_a_time_hash(const char *key) {
@@ -43,14 +416,18 @@ uint32_t jenkins_one_at_a_time_hash(const char *key) {
     return hash;
 }
 
-hashRecord *hash_table_find(HashTable *table, const char *name) {
+hashRecord *hash_table_find(HashTable *table, const char *name, uint32_t target_hash) {
     if (!table || !name) {
         return NULL;
     }
-    uint32_t target_hash = jenkins_one_at_a_time_hash(name);
     hashRecord *current = table->head;
+    uint64_t probes = 0;
+    ++thread_counters.lookups;
     while (current) {
+        ++probes;
         if (current->hash == target_hash && strncmp(current->name, name, HASH_NAME_MAX) == 0) {
+            count_probes(probes);
+            touch_record(table, current);
             return current;
         }
         if (current->hash > target_hash) {
@@ -58,6 +435,20 @@ hashRecord *hash_table_find(HashTable *table, const char *name) {
         }
         current = current->next;
     }
+    count_probes(probes);
+    if (table->memory_cap) {
+        size_t position = cold_store_find(&table->cold, target_hash, name);
+        if (position != COLD_STORE_NOT_FOUND) {
+            uint32_t slot = table->cold.index[position].slot;
+            cold_result.hash = target_hash;
+            cold_store_read(&table->cold, slot, cold_result.name, sizeof(cold_result.name), &cold_result.salary);
+            cold_result.next = NULL;
+            if (cold_store_note_read(&table->cold, slot)) {
+                request_promotion(table, target_hash, cold_result.name, slot);
+            }
+            return &cold_result;
+        }
+    }
     return NULL;
 }
 
@@ -72,29 +463,41 @@ int hash_table_insert_locked(HashTable *table, const char *name, uint32_t salary
     if (was_update) {
         *was_update = 0;
     }
+    apply_promotions(table);
+    advance_epoch(table);
     hashRecord *prev = NULL;
     hashRecord *current = table->head;
+    uint64_t probes = 0;
     while (current && current->hash < hash) {
+        ++probes;
         prev = current;
         current = current->next;
     }
     while (current && current->hash == hash) {
+        ++probes;
         int name_cmp = strncmp(current->name, name, HASH_NAME_MAX);
         if (name_cmp == 0) {
             if (prev_salary) {
                 *prev_salary = current->salary;
             }
+            bump_version(table, hash);
             current->salary = salary;
+            touch_record(table, current);
             if (was_update) {
                 *was_update = 1;
             }
+            ++thread_counters.updates;
+            count_probes(probes);
             return 0;
         }
         prev = current;
         current = current->next;
     }
+    count_probes(probes);
 
-    hashRecord *node = (hashRecord *)calloc(1, sizeof(hashRecord));
+    // A spilled record that is written again is promoted back to the chain.
+    size_t cold_position = table->memory_cap ? cold_store_find(&table->cold, hash, name) : COLD_STORE_NOT_FOUND;
+    hashRecord *node = allocate_record(table, hash);
     if (!node) {
         return -1;
     }
@@ -102,7 +505,9 @@ int hash_table_insert_locked(HashTable *table, const char *name, uint32_t salary
     strncpy(node->name, name, HASH_NAME_MAX);
     node->name[HASH_NAME_MAX] = '\0';
     node->salary = salary;
+    atomic_init(&node->last_access, atomic_load_explicit(&table->access_epoch, memory_order_relaxed));
 
+    bump_version(table, hash);
     if (!prev) {
         node->next = table->head;
         table->head = node;
@@ -110,6 +515,31 @@ int hash_table_insert_locked(HashTable *table, const char *name, uint32_t salary
         node->next = prev->next;
         prev->next = node;
     }
+    ++table->resident_count;
+    if (cold_position != COLD_STORE_NOT_FOUND) {
+        uint32_t cold_salary = 0;
+        cold_store_read(&table->cold, table->cold.index[cold_position].slot, NULL, 0, &cold_salary);
+        cold_store_remove(&table->cold, cold_position);
+        if (prev_salary) {
+            *prev_salary = cold_salary;
+        }
+        if (was_update) {
+            *was_update = 1;
+        }
+        ++table->promotions;
+        ++thread_counters.updates;
+    } else {
+        ++table->record_count;
+        membership_filter_add(&table->filter, hash, node->name);
+        int reason = membership_filter_needs_rebuild(&table->filter, table->record_count);
+        if (reason != FILTER_REBUILD_NONE) {
+            rebuild_filter(table, reason);
+        }
+        ++thread_counters.inserts;
+    }
+    if (table->memory_cap && resident_bytes(table) > table->memory_cap) {
+        evict_cold_records(table);
+    }
     return 0;
 }
 
@@ -118,14 +548,23 @@ int hash_table_delete_locked(HashTable *table, const char *name, uint32_t hash,
     if (!table || !name) {
         return -1;
     }
+    apply_promotions(table);
+    advance_epoch(table);
+    if (table->memory_cap && resident_bytes(table) > table->memory_cap) {
+        evict_cold_records(table);
+    }
     hashRecord *prev = NULL;
     hashRecord *current = table->head;
+    uint64_t probes = 0;
     while (current && current->hash < hash) {
+        ++probes;
         prev = current;
         current = current->next;
     }
     while (current && current->hash == hash) {
+        ++probes;
         if (strncmp(current->name, name, HASH_NAME_MAX) == 0) {
+            bump_version(table, hash);
             if (prev) {
                 prev->next = current->next;
             } else {
@@ -134,20 +573,47 @@ int hash_table_delete_locked(HashTable *table, const char *name, uint32_t hash,
             if (removed_salary) {
                 *removed_salary = current->salary;
             }
-            free(current);
+            --table->record_count;
+            --table->resident_count;
+            membership_filter_remove(&table->filter, hash, current->name);
+            release_record(table, current);
+            int reason = membership_filter_needs_rebuild(&table->filter, table->record_count);
+            if (reason != FILTER_REBUILD_NONE) {
+                rebuild_filter(table, reason);
+            }
+            ++thread_counters.deletes;
+            count_probes(probes);
             return 1;
         }
         prev = current;
         current = current->next;
     }
-    return 0;
+    count_probes(probes);
+    size_t cold_position = table->memory_cap ? cold_store_find(&table->cold, hash, name) : COLD_STORE_NOT_FOUND;
+    if (cold_position == COLD_STORE_NOT_FOUND) {
+        ++thread_counters.delete_misses;
+        return 0;
+    }
+    bump_version(table, hash);
+    if (removed_salary) {
+        cold_store_read(&table->cold, table->cold.index[cold_position].slot, NULL, 0, removed_salary);
+    }
+    cold_store_remove(&table->cold, cold_position);
+    --table->record_count;
+    membership_filter_remove(&table->filter, hash, name);
+    int reason = membership_filter_needs_rebuild(&table->filter, table->record_count);
+    if (reason != FILTER_REBUILD_NONE) {
+        rebuild_filter(table, reason);
+    }
+    ++thread_counters.deletes;
+    return 1;
 }
 
 hashRecord *hash_table_clone_records(HashTable *table, size_t *out_count) {
     if (!table || !out_count) {
         return NULL;
     }
-    size_t count = 0;
+    size_t count = table->cold.live;
     for (hashRecord *current = table->head; current; current = current->next) {
         ++count;
     }
@@ -160,11 +626,159 @@ hashRecord *hash_table_clone_records(HashTable *table, size_t *out_count) {
         *out_count = 0;
         return NULL;
     }
+    // Merge the resident chain with the cold index; both are sorted by hash.
+    const ColdStore *cold = &table->cold;
+    size_t cold_index = 0;
     size_t index = 0;
-    for (hashRecord *current = table->head; current && index < count; current = current->next) {
-        records[index] = *current;
+    hashRecord *current = table->head;
+    while (index < count) {
+        while (cold_index < cold->index_count && cold->index[cold_index].slot == COLD_SLOT_NONE) {
+            ++cold_index;
+        }
+        if (current && (cold_index == cold->index_count || current->hash <= cold->index[cold_index].hash)) {
+            records[index] = *current;
+            current = current->next;
+        } else if (cold_index < cold->index_count) {
+            const ColdIndexEntry *entry = &cold->index[cold_index++];
+            records[index].hash = entry->hash;
+            cold_store_read(cold, entry->slot, records[index].name, sizeof(records[index].name),
+                            &records[index].salary);
+        } else {
+            break;
+        }
         records[index].next = NULL;
         ++index;
     }
+    *out_count = index;
     return records;
 }
+
+void hash_table_count_lock(int write, int contended) {
+    if (write) {
+        ++thread_counters.write_locks;
+    } else {
+        ++thread_counters.read_locks;
+    }
+    if (contended) {
+        ++thread_counters.contended_locks;
+    }
+}
+
+void hash_table_flush_thread_counters(HashTable *table) {
+    if (!table) {
+        return;
+    }
+    HashTableCounters *counters = &table->counters;
+    ThreadCounters *local = &thread_counters;
+    atomic_fetch_add_explicit(&counters->lookups, local->lookups, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->inserts, local->inserts, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->updates, local->updates, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->deletes, local->deletes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->delete_misses, local->delete_misses, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->probes, local->probes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->read_locks, local->read_locks, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->write_locks, local->write_locks, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->contended_locks, local->contended_locks, memory_order_relaxed);
+    uint_fast64_t max_probe = atomic_load_explicit(&counters->max_probe, memory_order_relaxed);
+    while (local->max_probe > max_probe &&
+           !atomic_compare_exchange_weak_explicit(&counters->max_probe, &max_probe, local->max_probe,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    memset(local, 0, sizeof(*local));
+}
+
+void hash_table_collect_stats(HashTable *table, HashTableStats *stats) {
+    if (!table || !stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    // Resident records live on the single sorted chain; spilled ones only in
+    // the cold index. Both are sorted by hash, so merging them finds
+    // collisions within and across the tiers.
+    const hashRecord *current = table->head;
+    size_t cold_position = 0;
+    uint32_t previous_hash = 0;
+    for (;;) {
+        while (cold_position < table->cold.index_count &&
+               table->cold.index[cold_position].slot == COLD_SLOT_NONE) {
+            ++cold_position;
+        }
+        int cold_left = cold_position < table->cold.index_count;
+        if (!current && !cold_left) {
+            break;
+        }
+        uint32_t hash;
+        if (current && (!cold_left || current->hash <= table->cold.index[cold_position].hash)) {
+            hash = current->hash;
+            ++stats->resident_records;
+            current = current->next;
+        } else {
+            hash = table->cold.index[cold_position++].hash;
+            ++stats->cold_records;
+        }
+        if (stats->records++ > 0 && hash == previous_hash) {
+            ++stats->hash_collisions;
+        }
+        previous_hash = hash;
+    }
+    stats->chain_length = stats->resident_records;
+    stats->memory_bytes = sizeof(HashTable) + stats->resident_records * sizeof(hashRecord) +
+                          table->cold.index_capacity * sizeof(ColdIndexEntry);
+    stats->memory_cap = table->memory_cap;
+    stats->cold_file_bytes = cold_store_file_bytes(&table->cold);
+    stats->evictions = table->evictions;
+    stats->promotions = table->promotions;
+    stats->cap_exceeded = (uint64_t)table->cap_exceeded;
+    HashTableCounters *counters = &table->counters;
+    stats->lookups = atomic_load_explicit(&counters->lookups, memory_order_relaxed);
+    stats->inserts = atomic_load_explicit(&counters->inserts, memory_order_relaxed);
+    stats->updates = atomic_load_explicit(&counters->updates, memory_order_relaxed);
+    stats->deletes = atomic_load_explicit(&counters->deletes, memory_order_relaxed);
+    stats->delete_misses = atomic_load_explicit(&counters->delete_misses, memory_order_relaxed);
+    stats->probes = atomic_load_explicit(&counters->probes, memory_order_relaxed);
+    stats->max_probe = atomic_load_explicit(&counters->max_probe, memory_order_relaxed);
+    stats->read_locks = atomic_load_explicit(&counters->read_locks, memory_order_relaxed);
+    stats->write_locks = atomic_load_explicit(&counters->write_locks, memory_order_relaxed);
+    stats->contended_locks = atomic_load_explicit(&counters->contended_locks, memory_order_relaxed);
+    FilterTable *filter_table = atomic_load_explicit(&table->filter.current, memory_order_acquire);
+    if (filter_table) {
+        stats->filter_capacity = filter_table->capacity;
+        stats->filter_counters = filter_table->mask + 1;
+    }
+    stats->filter_rejections = atomic_load_explicit(&table->filter.rejections, memory_order_relaxed);
+    stats->filter_false_positives = atomic_load_explicit(&table->filter.false_positives, memory_order_relaxed);
+    stats->filter_rebuilds = table->filter.rebuilds;
+    stats->filter_fp_rate = membership_filter_fp_rate(&table->filter);
+}
+
+int hash_table_format_stats(const HashTableStats *stats, char *buffer, size_t size) {
+    if (!stats || !buffer) {
+        return -1;
+    }
+    // Every probing operation counts, including deletes of absent keys.
+    uint64_t operations = stats->lookups + stats->inserts + stats->updates + stats->deletes + stats->delete_misses;
+    double average_probe = operations ? (double)stats->probes / (double)operations : 0.0;
+    return snprintf(buffer, size,
+                    "records=%llu\nmemory_bytes=%llu\nchain_length=%llu\nhash_collisions=%llu\n"
+                    "lookups=%llu\ninserts=%llu\nupdates=%llu\ndeletes=%llu\ndelete_misses=%llu\n"
+                    "avg_probe=%.2f\nmax_probe=%llu\n"
+                    "read_locks=%llu\nwrite_locks=%llu\ncontended_locks=%llu\n"
+                    "filter_capacity=%llu\nfilter_counters=%llu\nfilter_rejections=%llu\n"
+                    "filter_false_positives=%llu\nfilter_fp_rate=%.4f\nfilter_rebuilds=%llu\n"
+                    "memory_cap=%llu\nresident_records=%llu\ncold_records=%llu\ncold_file_bytes=%llu\n"
+                    "evictions=%llu\npromotions=%llu\ncap_exceeded=%llu\n",
+                    (unsigned long long)stats->records, (unsigned long long)stats->memory_bytes,
+                    (unsigned long long)stats->chain_length, (unsigned long long)stats->hash_collisions,
+                    (unsigned long long)stats->lookups, (unsigned long long)stats->inserts,
+                    (unsigned long long)stats->updates, (unsigned long long)stats->deletes,
+                    (unsigned long long)stats->delete_misses, average_probe,
+                    (unsigned long long)stats->max_probe, (unsigned long long)stats->read_locks,
+                    (unsigned long long)stats->write_locks, (unsigned long long)stats->contended_locks,
+                    (unsigned long long)stats->filter_capacity, (unsigned long long)stats->filter_counters,
+                    (unsigned long long)stats->filter_rejections, (unsigned long long)stats->filter_false_positives,
+                    stats->filter_fp_rate, (unsigned long long)stats->filter_rebuilds,
+                    (unsigned long long)stats->memory_cap, (unsigned long long)stats->resident_records,
+                    (unsigned long long)stats->cold_records, (unsigned long long)stats->cold_file_bytes,
+                    (unsigned long long)stats->evictions, (unsigned long long)stats->promotions,
+                    (unsigned long long)stats->cap_exceeded);
+}
@@ -0,0 +1,144 @@
+#include "hot_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void count(atomic_uint_fast64_t *counter) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+void hot_cache_init(HotKeyCache *cache) {
+    if (!cache) {
+        return;
+    }
+    memset(cache->entries, 0, sizeof(cache->entries));
+    atomic_init(&cache->hits, 0);
+    atomic_init(&cache->misses, 0);
+    cache->next = NULL;
+    cache->next_free = NULL;
+}
+
+int hot_cache_lookup(HotKeyCache *cache, HashTable *table, uint32_t hash, const char *name, uint32_t *salary) {
+    if (!cache || !table || !name) {
+        return 0;
+    }
+    const HotCacheEntry *entry = &cache->entries[hash & (HOT_CACHE_ENTRIES - 1)];
+    if (entry->valid && entry->hash == hash && entry->version == hash_table_version(table, hash) &&
+        entry->epoch == hash_table_access_epoch(table) &&
+        strncmp(entry->name, name, HASH_NAME_MAX) == 0) {
+        if (salary) {
+            *salary = entry->salary;
+        }
+        count(&cache->hits);
+        return 1;
+    }
+    count(&cache->misses);
+    return 0;
+}
+
+void hot_cache_store(HotKeyCache *cache, HashTable *table, uint32_t hash, const char *name, uint32_t salary) {
+    if (!cache || !table || !name) {
+        return;
+    }
+    HotCacheEntry *entry = &cache->entries[hash & (HOT_CACHE_ENTRIES - 1)];
+    entry->version = hash_table_version(table, hash);
+    entry->epoch = hash_table_access_epoch(table);
+    entry->hash = hash;
+    entry->salary = salary;
+    strncpy(entry->name, name, HASH_NAME_MAX);
+    entry->name[HASH_NAME_MAX] = '\0';
+    entry->valid = 1;
+}
+
+int hot_cache_pool_init(HotCachePool *pool) {
+    if (!pool) {
+        return -1;
+    }
+    pool->all = NULL;
+    pool->free_list = NULL;
+    pool->count = 0;
+    return pthread_mutex_init(&pool->mutex, NULL) == 0 ? 0 : -1;
+}
+
+void hot_cache_pool_destroy(HotCachePool *pool) {
+    if (!pool) {
+        return;
+    }
+    HotKeyCache *cache = pool->all;
+    while (cache) {
+        HotKeyCache *next = cache->next;
+        free(cache);
+        cache = next;
+    }
+    pool->all = NULL;
+    pool->free_list = NULL;
+    pthread_mutex_destroy(&pool->mutex);
+}
+
+HotKeyCache *hot_cache_pool_acquire(HotCachePool *pool) {
+    if (!pool) {
+        return NULL;
+    }
+    pthread_mutex_lock(&pool->mutex);
+    HotKeyCache *cache = pool->free_list;
+    if (cache) {
+        pool->free_list = cache->next_free;
+        pthread_mutex_unlock(&pool->mutex);
+        return cache;
+    }
+    if (pool->count >= HOT_CACHE_POOL_MAX) {
+        pthread_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+    ++pool->count;
+    pthread_mutex_unlock(&pool->mutex);
+
+    cache = (HotKeyCache *)malloc(sizeof(HotKeyCache));
+    if (!cache) {
+        pthread_mutex_lock(&pool->mutex);
+        --pool->count;
+        pthread_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+    hot_cache_init(cache);
+    pthread_mutex_lock(&pool->mutex);
+    cache->next = pool->all;
+    pool->all = cache;
+    pthread_mutex_unlock(&pool->mutex);
+    return cache;
+}
+
+void hot_cache_pool_release(HotCachePool *pool, HotKeyCache *cache) {
+    if (!pool || !cache) {
+        return;
+    }
+    pthread_mutex_lock(&pool->mutex);
+    cache->next_free = pool->free_list;
+    pool->free_list = cache;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void hot_cache_pool_collect_stats(HotCachePool *pool, HotCacheStats *stats) {
+    if (!pool || !stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    pthread_mutex_lock(&pool->mutex);
+    for (HotKeyCache *cache = pool->all; cache; cache = cache->next) {
+        ++stats->caches;
+        stats->hits += atomic_load_explicit(&cache->hits, memory_order_relaxed);
+        stats->misses += atomic_load_explicit(&cache->misses, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+int hot_cache_format_stats(const HotCacheStats *stats, char *buffer, size_t size) {
+    if (!stats || !buffer) {
+        return -1;
+    }
+    uint64_t lookups = stats->hits + stats->misses;
+    return snprintf(buffer, size, "hot_cache_caches=%llu\nhot_cache_hits=%llu\nhot_cache_misses=%llu\nhot_cache_hit_rate=%.4f\n",
+                    (unsigned long long)stats->caches, (unsigned long long)stats->hits,
+                    (unsigned long long)stats->misses, lookups ? (double)stats->hits / (double)lookups : 0.0);
+}
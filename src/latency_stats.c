@@ -0,0 +1,195 @@
+#include "latency_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static size_t bucket_index(uint64_t value) {
+    if (value < 2 * LATENCY_SUB_BUCKET_COUNT) {
+        return (size_t)value;
+    }
+    unsigned magnitude = 63u - (unsigned)__builtin_clzll(value);
+    if (magnitude > LATENCY_MAX_MAGNITUDE) {
+        return LATENCY_BUCKET_COUNT - 1;
+    }
+    unsigned shift = magnitude - LATENCY_SUB_BUCKET_BITS;
+    return (size_t)shift * LATENCY_SUB_BUCKET_COUNT + (size_t)(value >> shift);
+}
+
+static uint64_t bucket_upper_value(size_t index) {
+    if (index < 2 * LATENCY_SUB_BUCKET_COUNT) {
+        return index;
+    }
+    unsigned shift = (unsigned)(index / LATENCY_SUB_BUCKET_COUNT) - 1u;
+    uint64_t sub_bucket = index % LATENCY_SUB_BUCKET_COUNT + LATENCY_SUB_BUCKET_COUNT;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void latency_histogram_reset(LatencyHistogram *histogram) {
+    if (histogram) {
+        memset(histogram, 0, sizeof(*histogram));
+    }
+}
+
+void latency_histogram_record(LatencyHistogram *histogram, uint64_t nanoseconds) {
+    if (!histogram) {
+        return;
+    }
+    ++histogram->counts[bucket_index(nanoseconds)];
+    ++histogram->total;
+    histogram->sum += nanoseconds;
+    if (nanoseconds > histogram->max) {
+        histogram->max = nanoseconds;
+    }
+}
+
+void latency_histogram_merge(LatencyHistogram *target, const LatencyHistogram *source) {
+    if (!target || !source || source->total == 0) {
+        return;
+    }
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        target->counts[i] += source->counts[i];
+    }
+    target->total += source->total;
+    target->sum += source->sum;
+    if (source->max > target->max) {
+        target->max = source->max;
+    }
+}
+
+uint64_t latency_histogram_percentile(const LatencyHistogram *histogram, double percentile) {
+    if (!histogram || histogram->total == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)histogram->total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint64_t value = bucket_upper_value(i);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+int latency_stats_init(LatencyStats *stats) {
+    if (!stats) {
+        return -1;
+    }
+    for (int i = 0; i < LATENCY_METRIC_COUNT; ++i) {
+        LatencySharedHistogram *histogram = &stats->metrics[i];
+        for (size_t j = 0; j < LATENCY_BUCKET_COUNT; ++j) {
+            atomic_init(&histogram->counts[j], 0);
+        }
+        atomic_init(&histogram->total, 0);
+        atomic_init(&histogram->sum, 0);
+        atomic_init(&histogram->max, 0);
+    }
+    return 0;
+}
+
+void latency_stats_destroy(LatencyStats *stats) {
+    (void)stats;
+}
+
+// Copies one metric out of the shared stats. Taken while recorders are still
+// flushing, the copy may be a few samples behind but is never torn per field.
+void latency_stats_snapshot(LatencyStats *stats, LatencyMetric metric, LatencyHistogram *out) {
+    if (!out) {
+        return;
+    }
+    latency_histogram_reset(out);
+    if (!stats || metric >= LATENCY_METRIC_COUNT) {
+        return;
+    }
+    LatencySharedHistogram *histogram = &stats->metrics[metric];
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        out->counts[i] = atomic_load_explicit(&histogram->counts[i], memory_order_relaxed);
+    }
+    out->total = atomic_load_explicit(&histogram->total, memory_order_relaxed);
+    out->sum = atomic_load_explicit(&histogram->sum, memory_order_relaxed);
+    out->max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+}
+
+const char *latency_metric_to_string(LatencyMetric metric) {
+    switch (metric) {
+        case LATENCY_READ_LOCK_WAIT:
+            return "read_lock_wait";
+        case LATENCY_READ_LOCK_HOLD:
+            return "read_lock_hold";
+        case LATENCY_WRITE_LOCK_WAIT:
+            return "write_lock_wait";
+        case LATENCY_WRITE_LOCK_HOLD:
+            return "write_lock_hold";
+        case LATENCY_INSERT:
+            return "insert";
+        case LATENCY_DELETE:
+            return "delete";
+        case LATENCY_SEARCH:
+            return "search";
+        case LATENCY_PRINT:
+            return "print";
+        case LATENCY_STATS:
+            return "stats";
+        default:
+            return "unknown";
+    }
+}
+
+int latency_stats_write_report(LatencyStats *stats, const char *path) {
+    if (!stats || !path) {
+        return -1;
+    }
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        return -1;
+    }
+    fprintf(fp, "metric,count,mean_ns,p50_ns,p99_ns,p999_ns,max_ns\n");
+    LatencyHistogram snapshot;
+    for (int i = 0; i < LATENCY_METRIC_COUNT; ++i) {
+        latency_stats_snapshot(stats, (LatencyMetric)i, &snapshot);
+        const LatencyHistogram *histogram = &snapshot;
+        uint64_t mean = histogram->total ? histogram->sum / histogram->total : 0;
+        fprintf(fp, "%s,%llu,%llu,%llu,%llu,%llu,%llu\n", latency_metric_to_string((LatencyMetric)i),
+                (unsigned long long)histogram->total, (unsigned long long)mean,
+                (unsigned long long)latency_histogram_percentile(histogram, 50.0),
+                (unsigned long long)latency_histogram_percentile(histogram, 99.0),
+                (unsigned long long)latency_histogram_percentile(histogram, 99.9),
+                (unsigned long long)histogram->max);
+    }
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+void latency_recorder_add(LatencyRecorder *recorder, LatencyStats *stats, LatencyMetric metric, uint64_t nanoseconds) {
+    if (!recorder || !stats) {
+        return;
+    }
+    if (recorder->count == LATENCY_RECORDER_CAPACITY) {
+        latency_recorder_flush(recorder, stats);
+    }
+    recorder->samples[recorder->count].metric = metric;
+    recorder->samples[recorder->count].nanoseconds = nanoseconds;
+    ++recorder->count;
+}
+
+void latency_recorder_flush(LatencyRecorder *recorder, LatencyStats *stats) {
+    if (!recorder || !stats || recorder->count == 0) {
+        return;
+    }
+    for (size_t i = 0; i < recorder->count; ++i) {
+        LatencySharedHistogram *histogram = &stats->metrics[recorder->samples[i].metric];
+        uint64_t nanoseconds = recorder->samples[i].nanoseconds;
+        atomic_fetch_add_explicit(&histogram->counts[bucket_index(nanoseconds)], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&histogram->total, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&histogram->sum, nanoseconds, memory_order_relaxed);
+        uint_fast64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+        while (nanoseconds > max &&
+               !atomic_compare_exchange_weak_explicit(&histogram->max, &max, nanoseconds, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+        }
+    }
+    recorder->count = 0;
+}
@@ -1,61 +1,276 @@
 #include "logger.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "timestamp.h"
 
+#define LOG_KIND_COMMAND 0u
+#define LOG_KIND_STATUS 1u
+#define LOG_KIND_INSERT 2u
+#define LOG_KIND_DELETE 3u
+#define LOG_KIND_SEARCH 4u
+#define LOGGER_BATCH_BYTES (64u * 1024u)
+// Longest line beyond the text: timestamp, thread, verb, hash and salary.
+#define LOGGER_LINE_OVERHEAD 96u
+
+static int write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return -1;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+// Reports the first failed write; later batches are still drained so
+// producers never block on a ring that cannot empty.
+static void flush_batch(Logger *logger, const char *batch, size_t length) {
+    if (write_all(logger->fd, batch, length) != 0 && !logger->write_error) {
+        logger->write_error = 1;
+        fprintf(stderr, "Failed writing log file: %s\n", strerror(errno));
+    }
+}
+
+// Blocks (yielding) while the ring is full so memory stays bounded.
+static LogEntry *claim_entry(Logger *logger) {
+    size_t position = atomic_load_explicit(&logger->head, memory_order_relaxed);
+    for (;;) {
+        LogEntry *entry = &logger->ring[position & (LOGGER_RING_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&logger->head, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                return entry;
+            }
+        } else if (difference < 0) {
+            sched_yield();
+            position = atomic_load_explicit(&logger->head, memory_order_relaxed);
+        } else {
+            position = atomic_load_explicit(&logger->head, memory_order_relaxed);
+        }
+    }
+}
+
+static void publish_entry(Logger *logger, LogEntry *entry) {
+    size_t position = atomic_load_explicit(&entry->sequence, memory_order_relaxed);
+    // Sequentially consistent with the flusher's `sleeping` store and re-check,
+    // so either it sees this entry or we see it asleep.
+    atomic_store(&entry->sequence, position + 1);
+    if (atomic_load(&logger->sleeping)) {
+        pthread_mutex_lock(&logger->mutex);
+        pthread_cond_signal(&logger->wake);
+        pthread_mutex_unlock(&logger->mutex);
+    }
+}
+
+static int entry_ready(Logger *logger) {
+    LogEntry *entry = &logger->ring[logger->tail & (LOGGER_RING_CAPACITY - 1)];
+    return atomic_load(&entry->sequence) == logger->tail + 1;
+}
+
+static int format_entry(const LogEntry *entry, char *out, size_t size) {
+    switch (entry->kind) {
+        case LOG_KIND_INSERT:
+            return snprintf(out, size, "%lld,THREAD %u,INSERT,%u,%s,%u\n", entry->timestamp, entry->priority,
+                            entry->hash, entry->text, entry->salary);
+        case LOG_KIND_DELETE:
+        case LOG_KIND_SEARCH:
+            return snprintf(out, size, "%lld,THREAD %u,%s,%u,%s\n", entry->timestamp, entry->priority,
+                            entry->kind == LOG_KIND_DELETE ? "DELETE" : "SEARCH", entry->hash, entry->text);
+        case LOG_KIND_COMMAND:
+            return snprintf(out, size, "%lld,THREAD %u,%s\n", entry->timestamp, entry->priority, entry->text);
+        default:
+            return snprintf(out, size, "%lld,THREAD %u%s\n", entry->timestamp, entry->priority, entry->text);
+    }
+}
+
+// Formats every published entry into batched writes; returns the number drained.
+static size_t drain_ring(Logger *logger, char *batch) {
+    size_t used = 0;
+    size_t drained = 0;
+    for (;;) {
+        LogEntry *entry = &logger->ring[logger->tail & (LOGGER_RING_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+        if (sequence != logger->tail + 1) {
+            break;
+        }
+        if (LOGGER_BATCH_BYTES - used < LOGGER_TEXT_MAX + LOGGER_LINE_OVERHEAD) {
+            flush_batch(logger, batch, used);
+            used = 0;
+        }
+        // Producers stamp after claiming, so slots are nearly in time order;
+        // clamp the rare inversion from a producer preempted in between.
+        if (entry->timestamp < logger->last_timestamp) {
+            entry->timestamp = logger->last_timestamp;
+        }
+        logger->last_timestamp = entry->timestamp;
+        int length = format_entry(entry, batch + used, LOGGER_BATCH_BYTES - used);
+        if (length > 0) {
+            used += (size_t)length;
+        }
+        atomic_store_explicit(&entry->sequence, logger->tail + LOGGER_RING_CAPACITY, memory_order_release);
+        ++logger->tail;
+        ++drained;
+    }
+    if (used > 0) {
+        flush_batch(logger, batch, used);
+    }
+    return drained;
+}
+
+static void *flusher_main(void *arg) {
+    Logger *logger = (Logger *)arg;
+    for (;;) {
+        int running = atomic_load_explicit(&logger->running, memory_order_acquire);
+        if (drain_ring(logger, logger->batch) > 0) {
+            continue;
+        }
+        if (!running) {
+            break;
+        }
+        pthread_mutex_lock(&logger->mutex);
+        atomic_store(&logger->sleeping, 1);
+        while (!entry_ready(logger) && atomic_load(&logger->running)) {
+            pthread_cond_wait(&logger->wake, &logger->mutex);
+        }
+        atomic_store(&logger->sleeping, 0);
+        pthread_mutex_unlock(&logger->mutex);
+    }
+    return NULL;
+}
+
 int logger_init(Logger *logger, const char *path) {
     if (!logger || !path) {
         return -1;
     }
-    logger->fp = fopen(path, "w");
-    if (!logger->fp) {
+    logger->ring = NULL;
+    logger->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (logger->fd < 0) {
         return -1;
     }
-    if (pthread_mutex_init(&logger->mutex, NULL) != 0) {
-        fclose(logger->fp);
-        logger->fp = NULL;
+    logger->ring = (LogEntry *)calloc(LOGGER_RING_CAPACITY, sizeof(LogEntry));
+    logger->batch = (char *)malloc(LOGGER_BATCH_BYTES);
+    if (!logger->ring || !logger->batch) {
+        free(logger->ring);
+        free(logger->batch);
+        logger->ring = NULL;
+        logger->batch = NULL;
+        close(logger->fd);
+        logger->fd = -1;
+        return -1;
+    }
+    for (size_t i = 0; i < LOGGER_RING_CAPACITY; ++i) {
+        atomic_init(&logger->ring[i].sequence, i);
+    }
+    atomic_init(&logger->head, 0);
+    logger->tail = 0;
+    logger->last_timestamp = 0;
+    logger->write_error = 0;
+    atomic_init(&logger->running, 1);
+    atomic_init(&logger->sleeping, 0);
+    pthread_mutex_init(&logger->mutex, NULL);
+    pthread_cond_init(&logger->wake, NULL);
+    if (pthread_create(&logger->flusher, NULL, flusher_main, logger) != 0) {
+        pthread_cond_destroy(&logger->wake);
+        pthread_mutex_destroy(&logger->mutex);
+        free(logger->ring);
+        free(logger->batch);
+        logger->ring = NULL;
+        logger->batch = NULL;
+        close(logger->fd);
+        logger->fd = -1;
         return -1;
     }
     return 0;
 }
 
 void logger_close(Logger *logger) {
-    if (!logger) {
+    if (!logger || !logger->ring) {
         return;
     }
-    if (logger->fp) {
-        fflush(logger->fp);
-        fclose(logger->fp);
-        logger->fp = NULL;
-    }
+    pthread_mutex_lock(&logger->mutex);
+    atomic_store(&logger->running, 0);
+    pthread_cond_signal(&logger->wake);
+    pthread_mutex_unlock(&logger->mutex);
+    pthread_join(logger->flusher, NULL);
+    pthread_cond_destroy(&logger->wake);
     pthread_mutex_destroy(&logger->mutex);
+    free(logger->ring);
+    free(logger->batch);
+    logger->ring = NULL;
+    logger->batch = NULL;
+    close(logger->fd);
+    logger->fd = -1;
 }
 
 void logger_log_command(Logger *logger, uint32_t priority, const char *format, ...) {
-    if (!logger || !logger->fp || !format) {
+    if (!logger || !logger->ring || !format) {
         return;
     }
-    pthread_mutex_lock(&logger->mutex);
-    long long timestamp = current_timestamp_microseconds();
-    char buffer[512];
+    LogEntry *entry = claim_entry(logger);
+    entry->timestamp = current_timestamp_microseconds();
+    entry->priority = priority;
+    entry->kind = LOG_KIND_COMMAND;
     va_list args;
     va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    vsnprintf(entry->text, sizeof(entry->text), format, args);
     va_end(args);
-    fprintf(logger->fp, "%lld,THREAD %u,%s\n", timestamp, priority, buffer);
-    fflush(logger->fp);
-    pthread_mutex_unlock(&logger->mutex);
+    publish_entry(logger, entry);
 }
 
 void logger_log_status(Logger *logger, uint32_t priority, const char *status) {
-    if (!logger || !logger->fp || !status) {
+    if (!logger || !logger->ring || !status) {
         return;
     }
-    pthread_mutex_lock(&logger->mutex);
-    long long timestamp = current_timestamp_microseconds();
-    fprintf(logger->fp, "%lld,THREAD %u%s\n", timestamp, priority, status);
-    fflush(logger->fp);
-    pthread_mutex_unlock(&logger->mutex);
+    LogEntry *entry = claim_entry(logger);
+    entry->timestamp = current_timestamp_microseconds();
+    entry->priority = priority;
+    entry->kind = LOG_KIND_STATUS;
+    size_t length = strnlen(status, sizeof(entry->text) - 1);
+    memcpy(entry->text, status, length);
+    entry->text[length] = '\0';
+    publish_entry(logger, entry);
+}
+
+static void log_keyed(Logger *logger, uint32_t priority, uint32_t kind, uint32_t hash, const char *name,
+                      uint32_t salary) {
+    if (!logger || !logger->ring || !name) {
+        return;
+    }
+    LogEntry *entry = claim_entry(logger);
+    entry->timestamp = current_timestamp_microseconds();
+    entry->priority = priority;
+    entry->kind = kind;
+    entry->hash = hash;
+    entry->salary = salary;
+    size_t length = strnlen(name, sizeof(entry->text) - 1);
+    memcpy(entry->text, name, length);
+    entry->text[length] = '\0';
+    publish_entry(logger, entry);
+}
+
+void logger_log_insert(Logger *logger, uint32_t priority, uint32_t hash, const char *name, uint32_t salary) {
+    log_keyed(logger, priority, LOG_KIND_INSERT, hash, name, salary);
+}
+
+void logger_log_delete(Logger *logger, uint32_t priority, uint32_t hash, const char *name) {
+    log_keyed(logger, priority, LOG_KIND_DELETE, hash, name, 0);
+}
+
+void logger_log_search(Logger *logger, uint32_t priority, uint32_t hash, const char *name) {
+    log_keyed(logger, priority, LOG_KIND_SEARCH, hash, name, 0);
 }
@@ -0,0 +1,239 @@
+#include "membership_filter.h"
+
+#include <stdlib.h>
+
+#include "hash_table.h"
+
+// Second, independent hash for double hashing (FNV-1a with a seeded basis);
+// forced odd so every probe sequence visits distinct counters.
+static uint32_t secondary_hash(const char *name, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; name[i] && i < HASH_NAME_MAX; ++i) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash | 1u;
+}
+
+// First probe position; the seed is spread over all bits so a reseeded table
+// starts every key somewhere else.
+static uint32_t probe_start(const FilterTable *table, uint32_t hash) {
+    return hash ^ (table->seed * 0x9E3779B9u);
+}
+
+FilterTable *filter_table_create(size_t capacity, uint32_t seed) {
+    if (capacity < FILTER_MIN_CAPACITY) {
+        capacity = FILTER_MIN_CAPACITY;
+    }
+    size_t counters = 1;
+    while (counters < capacity * FILTER_COUNTERS_PER_KEY) {
+        counters <<= 1;
+    }
+    FilterTable *table = (FilterTable *)calloc(1, sizeof(FilterTable) + counters * sizeof(atomic_uchar));
+    if (!table) {
+        return NULL;
+    }
+    table->capacity = capacity;
+    table->mask = counters - 1;
+    table->seed = seed;
+    table->retired_next = NULL;
+    return table;
+}
+
+static void adjust_counters(FilterTable *table, uint32_t hash, const char *name, int delta) {
+    if (!table) {
+        return;
+    }
+    uint32_t start = probe_start(table, hash);
+    uint32_t step = secondary_hash(name, table->seed);
+    for (unsigned i = 0; i < FILTER_HASH_COUNT; ++i) {
+        atomic_uchar *counter = &table->counters[(start + i * step) & table->mask];
+        unsigned char value = atomic_load_explicit(counter, memory_order_relaxed);
+        if (value == UINT8_MAX || (delta < 0 && value == 0)) {
+            continue; // saturated counters are sticky
+        }
+        atomic_store_explicit(counter, (unsigned char)(value + delta), memory_order_release);
+    }
+}
+
+void filter_table_add(FilterTable *table, uint32_t hash, const char *name) {
+    if (table && name) {
+        adjust_counters(table, hash, name, 1);
+    }
+}
+
+int membership_filter_init(MembershipFilter *filter, int enabled) {
+    if (!filter) {
+        return -1;
+    }
+    FilterTable *table = enabled ? filter_table_create(FILTER_MIN_CAPACITY, 0) : NULL;
+    atomic_init(&filter->current, table);
+    filter->retired = NULL;
+    atomic_init(&filter->active_readers, 0);
+    filter->enabled = table ? enabled : 0;
+    atomic_init(&filter->rejections, 0);
+    atomic_init(&filter->false_positives, 0);
+    atomic_init(&filter->window_rejections, 0);
+    atomic_init(&filter->window_false_positives, 0);
+    filter->window_samples = FILTER_MIN_SAMPLES;
+    filter->next_seed = 0;
+    filter->rebuilds = 0;
+    return table || !enabled ? 0 : -1;
+}
+
+void membership_filter_set_enabled(MembershipFilter *filter, int enabled) {
+    if (filter) {
+        filter->enabled = enabled;
+    }
+}
+
+// Frees retired tables once no reader is mid-query. Readers announce
+// themselves before loading `current`, so a zero count observed after the
+// swap means nobody can still hold a retired table. Caller holds the write lock.
+static void reclaim_retired(MembershipFilter *filter) {
+    if (!filter->retired || atomic_load(&filter->active_readers) != 0) {
+        return;
+    }
+    while (filter->retired) {
+        FilterTable *next = filter->retired->retired_next;
+        free(filter->retired);
+        filter->retired = next;
+    }
+}
+
+void membership_filter_destroy(MembershipFilter *filter) {
+    if (!filter) {
+        return;
+    }
+    free(atomic_load(&filter->current));
+    atomic_store(&filter->current, NULL);
+    while (filter->retired) {
+        FilterTable *next = filter->retired->retired_next;
+        free(filter->retired);
+        filter->retired = next;
+    }
+}
+
+void membership_filter_add(MembershipFilter *filter, uint32_t hash, const char *name) {
+    if (filter && filter->enabled && name) {
+        reclaim_retired(filter);
+        adjust_counters(atomic_load_explicit(&filter->current, memory_order_relaxed), hash, name, 1);
+    }
+}
+
+void membership_filter_remove(MembershipFilter *filter, uint32_t hash, const char *name) {
+    if (filter && filter->enabled && name) {
+        reclaim_retired(filter);
+        adjust_counters(atomic_load_explicit(&filter->current, memory_order_relaxed), hash, name, -1);
+    }
+}
+
+int membership_filter_may_contain(MembershipFilter *filter, uint32_t hash, const char *name) {
+    if (!filter || !filter->enabled || !name) {
+        return 1;
+    }
+    atomic_fetch_add(&filter->active_readers, 1);
+    FilterTable *table = atomic_load(&filter->current);
+    int present = 1;
+    if (table) {
+        uint32_t start = probe_start(table, hash);
+        uint32_t step = secondary_hash(name, table->seed);
+        for (unsigned i = 0; i < FILTER_HASH_COUNT && present; ++i) {
+            present = atomic_load_explicit(&table->counters[(start + i * step) & table->mask], memory_order_acquire) != 0;
+        }
+    }
+    atomic_fetch_sub(&filter->active_readers, 1);
+    if (!present) {
+        atomic_fetch_add_explicit(&filter->rejections, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&filter->window_rejections, 1, memory_order_relaxed);
+    }
+    return present;
+}
+
+void membership_filter_note_false_positive(MembershipFilter *filter) {
+    if (filter && filter->enabled) {
+        atomic_fetch_add_explicit(&filter->false_positives, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&filter->window_false_positives, 1, memory_order_relaxed);
+    }
+}
+
+int membership_filter_needs_rebuild(MembershipFilter *filter, size_t records) {
+    if (!filter || !filter->enabled) {
+        return FILTER_REBUILD_NONE;
+    }
+    FilterTable *table = atomic_load_explicit(&filter->current, memory_order_relaxed);
+    if (!table) {
+        return FILTER_REBUILD_RESIZE;
+    }
+    if (records > table->capacity) {
+        return FILTER_REBUILD_RESIZE;
+    }
+    if (table->capacity > FILTER_MIN_CAPACITY && records < table->capacity / 4) {
+        return FILTER_REBUILD_RESIZE;
+    }
+    uint64_t false_positives = atomic_load_explicit(&filter->window_false_positives, memory_order_relaxed);
+    uint64_t negatives = false_positives + atomic_load_explicit(&filter->window_rejections, memory_order_relaxed);
+    if (negatives < filter->window_samples) {
+        return FILTER_REBUILD_NONE;
+    }
+    if ((double)false_positives > FILTER_REBUILD_FP_RATE * (double)negatives) {
+        return FILTER_REBUILD_DRIFT;
+    }
+    // A clean window: start the next one and let the backoff decay.
+    atomic_store_explicit(&filter->window_rejections, 0, memory_order_relaxed);
+    atomic_store_explicit(&filter->window_false_positives, 0, memory_order_relaxed);
+    if (filter->window_samples > FILTER_MIN_SAMPLES) {
+        filter->window_samples /= 2;
+    }
+    return FILTER_REBUILD_NONE;
+}
+
+FilterTable *membership_filter_rebuild_table(MembershipFilter *filter, size_t records, int reason) {
+    if (!filter) {
+        return NULL;
+    }
+    FilterTable *current = atomic_load_explicit(&filter->current, memory_order_relaxed);
+    size_t capacity = records * 2;
+    if (reason != FILTER_REBUILD_DRIFT || !current) {
+        return filter_table_create(capacity, current ? current->seed : filter->next_seed);
+    }
+    // Same keys, same size and same probes would rebuild the same counters, so
+    // a drift rebuild reseeds and grows. Growth stops at four times the records,
+    // where the shrink rule would otherwise undo it on the next write.
+    size_t grown = current->capacity * 2;
+    if (grown > records * 4) {
+        grown = records * 4;
+    }
+    if (grown > capacity) {
+        capacity = grown;
+    }
+    if (filter->window_samples < FILTER_MAX_SAMPLES) {
+        filter->window_samples *= 2;
+    }
+    return filter_table_create(capacity, ++filter->next_seed);
+}
+
+void membership_filter_publish(MembershipFilter *filter, FilterTable *table) {
+    if (!filter || !table) {
+        return;
+    }
+    FilterTable *previous = atomic_load_explicit(&filter->current, memory_order_relaxed);
+    atomic_store(&filter->current, table);
+    if (previous) {
+        previous->retired_next = filter->retired;
+        filter->retired = previous;
+    }
+    atomic_store_explicit(&filter->window_rejections, 0, memory_order_relaxed);
+    atomic_store_explicit(&filter->window_false_positives, 0, memory_order_relaxed);
+    ++filter->rebuilds;
+    reclaim_retired(filter);
+}
+
+double membership_filter_fp_rate(MembershipFilter *filter) {
+    if (!filter) {
+        return 0.0;
+    }
+    uint64_t false_positives = atomic_load_explicit(&filter->false_positives, memory_order_relaxed);
+    uint64_t negatives = false_positives + atomic_load_explicit(&filter->rejections, memory_order_relaxed);
+    return negatives ? (double)false_positives / (double)negatives : 0.0;
+}
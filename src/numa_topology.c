@@ -0,0 +1,276 @@
+#define _GNU_SOURCE
+#include "numa_topology.h"
+
+#include <dirent.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define NUMA_DEFAULT_SYSFS_ROOT "/sys/devices/system/node"
+#define NUMA_MPOL_PREFERRED 1
+#define NUMA_MPOL_INTERLEAVE 3
+#define NUMA_MASK_WORD_BITS (8 * sizeof(unsigned long))
+
+// Precedes every pool object: the owning node while allocated, the free-list
+// link while free. Sized to keep objects max-aligned.
+typedef union {
+    struct {
+        void *next;
+        size_t node;
+    } link;
+    max_align_t align;
+} NumaPoolHeader;
+
+_Static_assert(sizeof(NumaPoolChunk) <= sizeof(NumaPoolHeader), "chunk header must fit before the first object");
+
+// Parses a sysfs cpulist such as "0-3,8-11"; returns the CPU count or -1.
+static int parse_cpulist(const char *text, int **out_cpus) {
+    int *cpus = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    const char *cursor = text;
+    while (*cursor && *cursor != '\n') {
+        char *end = NULL;
+        long first = strtol(cursor, &end, 10);
+        if (end == cursor || first < 0) {
+            free(cpus);
+            return -1;
+        }
+        long last = first;
+        cursor = end;
+        if (*cursor == '-') {
+            last = strtol(cursor + 1, &end, 10);
+            if (end == cursor + 1 || last < first) {
+                free(cpus);
+                return -1;
+            }
+            cursor = end;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            if (count == capacity) {
+                size_t new_capacity = capacity ? capacity * 2 : 8;
+                int *resized = (int *)realloc(cpus, new_capacity * sizeof(int));
+                if (!resized) {
+                    free(cpus);
+                    return -1;
+                }
+                cpus = resized;
+                capacity = new_capacity;
+            }
+            cpus[count++] = (int)cpu;
+        }
+        if (*cursor == ',') {
+            ++cursor;
+        }
+    }
+    *out_cpus = cpus;
+    return (int)count;
+}
+
+static int compare_nodes(const void *left, const void *right) {
+    return ((const NumaNode *)left)->id - ((const NumaNode *)right)->id;
+}
+
+int numa_topology_init(NumaTopology *topology, const char *sysfs_root) {
+    if (!topology) {
+        return -1;
+    }
+    memset(topology, 0, sizeof(*topology));
+    const char *root = sysfs_root ? sysfs_root : NUMA_DEFAULT_SYSFS_ROOT;
+    DIR *directory = opendir(root);
+    if (!directory) {
+        return 0; // no NUMA information: behave as a single node
+    }
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL && topology->node_count < NUMA_MAX_NODES) {
+        int id;
+        char trailing;
+        if (sscanf(entry->d_name, "node%d%c", &id, &trailing) != 1 || id < 0) {
+            continue;
+        }
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s/cpulist", root, entry->d_name);
+        FILE *fp = fopen(path, "r");
+        if (!fp) {
+            continue;
+        }
+        char line[4096];
+        int cpu_count = 0;
+        int *cpus = NULL;
+        if (fgets(line, sizeof(line), fp)) {
+            cpu_count = parse_cpulist(line, &cpus);
+        }
+        fclose(fp);
+        if (cpu_count <= 0) {
+            free(cpus);
+            continue; // memory-only or unreadable node
+        }
+        NumaNode *node = &topology->nodes[topology->node_count++];
+        node->id = id;
+        node->cpus = cpus;
+        node->cpu_count = (size_t)cpu_count;
+        atomic_init(&node->next_cpu, 0);
+    }
+    closedir(directory);
+    qsort(topology->nodes, topology->node_count, sizeof(NumaNode), compare_nodes);
+    topology->enabled = topology->node_count > 1;
+    return 0;
+}
+
+void numa_topology_destroy(NumaTopology *topology) {
+    if (!topology) {
+        return;
+    }
+    for (size_t i = 0; i < topology->node_count; ++i) {
+        free(topology->nodes[i].cpus);
+    }
+    memset(topology, 0, sizeof(*topology));
+}
+
+size_t numa_node_for_hash(const NumaTopology *topology, uint32_t hash) {
+    if (!topology || !topology->enabled) {
+        return 0;
+    }
+    return hash % topology->node_count;
+}
+
+int numa_pin_thread_attr(NumaTopology *topology, size_t node, pthread_attr_t *attr) {
+    if (!topology || !attr || !topology->enabled || node >= topology->node_count) {
+        return 0;
+    }
+    NumaNode *target = &topology->nodes[node];
+    size_t slot = atomic_fetch_add_explicit(&target->next_cpu, 1, memory_order_relaxed);
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(target->cpus[slot % target->cpu_count], &cpus);
+    return pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus) == 0 ? 0 : -1;
+}
+
+// Best effort: without the policy the pages are still usable, just first-touch placed.
+static void apply_memory_policy(void *memory, size_t size, int mode, const unsigned long *mask, int max_id) {
+#ifdef SYS_mbind
+    syscall(SYS_mbind, memory, size, mode, mask, (unsigned long)max_id + 2, 0u);
+#else
+    (void)memory;
+    (void)size;
+    (void)mode;
+    (void)mask;
+    (void)max_id;
+#endif
+}
+
+void *numa_alloc_interleaved(const NumaTopology *topology, size_t size) {
+    if (size == 0) {
+        return NULL;
+    }
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return NULL;
+    }
+    if (topology && topology->enabled) {
+        unsigned long mask[NUMA_MAX_NODES / NUMA_MASK_WORD_BITS + 1] = {0};
+        int max_id = 0;
+        for (size_t i = 0; i < topology->node_count; ++i) {
+            int id = topology->nodes[i].id;
+            if (id < NUMA_MAX_NODES) {
+                mask[id / NUMA_MASK_WORD_BITS] |= 1ul << (id % NUMA_MASK_WORD_BITS);
+                max_id = id > max_id ? id : max_id;
+            }
+        }
+        apply_memory_policy(memory, size, NUMA_MPOL_INTERLEAVE, mask, max_id);
+    }
+    return memory;
+}
+
+void numa_free_interleaved(void *memory, size_t size) {
+    if (memory && size > 0) {
+        munmap(memory, size);
+    }
+}
+
+int numa_pool_init(NumaObjectPool *pool, const NumaTopology *topology, size_t object_size) {
+    if (!pool || object_size == 0) {
+        return -1;
+    }
+    memset(pool, 0, sizeof(*pool));
+    pool->topology = topology;
+    pool->object_size = object_size;
+    size_t alignment = sizeof(NumaPoolHeader);
+    pool->stride = sizeof(NumaPoolHeader) + (object_size + alignment - 1) / alignment * alignment;
+    return pool->stride <= NUMA_POOL_CHUNK_BYTES - sizeof(NumaPoolHeader) ? 0 : -1;
+}
+
+void numa_pool_destroy(NumaObjectPool *pool) {
+    if (!pool) {
+        return;
+    }
+    while (pool->chunks) {
+        NumaPoolChunk *next = pool->chunks->next;
+        munmap(pool->chunks, pool->chunks->bytes);
+        pool->chunks = next;
+    }
+    memset(pool->free_lists, 0, sizeof(pool->free_lists));
+}
+
+// Maps a chunk preferring `node` and threads its objects onto that node's
+// free list; writing the links first-touches the pages under the policy.
+static int grow_pool(NumaObjectPool *pool, size_t node) {
+    void *memory = mmap(NULL, NUMA_POOL_CHUNK_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return -1;
+    }
+    const NumaTopology *topology = pool->topology;
+    if (topology && topology->enabled && node < topology->node_count) {
+        int id = topology->nodes[node].id;
+        if (id < NUMA_MAX_NODES) {
+            unsigned long mask[NUMA_MAX_NODES / NUMA_MASK_WORD_BITS + 1] = {0};
+            mask[id / NUMA_MASK_WORD_BITS] |= 1ul << (id % NUMA_MASK_WORD_BITS);
+            apply_memory_policy(memory, NUMA_POOL_CHUNK_BYTES, NUMA_MPOL_PREFERRED, mask, id);
+        }
+    }
+    NumaPoolChunk *chunk = (NumaPoolChunk *)memory;
+    chunk->bytes = NUMA_POOL_CHUNK_BYTES;
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    unsigned char *cursor = (unsigned char *)memory + sizeof(NumaPoolHeader);
+    unsigned char *end = (unsigned char *)memory + NUMA_POOL_CHUNK_BYTES;
+    for (; cursor + pool->stride <= end; cursor += pool->stride) {
+        NumaPoolHeader *header = (NumaPoolHeader *)cursor;
+        header->link.node = node;
+        header->link.next = pool->free_lists[node];
+        pool->free_lists[node] = header;
+    }
+    return 0;
+}
+
+void *numa_pool_alloc(NumaObjectPool *pool, size_t node) {
+    if (!pool) {
+        return NULL;
+    }
+    if (node >= NUMA_MAX_NODES) {
+        node = 0;
+    }
+    if (!pool->free_lists[node] && grow_pool(pool, node) != 0) {
+        return NULL;
+    }
+    NumaPoolHeader *header = (NumaPoolHeader *)pool->free_lists[node];
+    pool->free_lists[node] = header->link.next;
+    header->link.next = NULL;
+    void *object = header + 1;
+    memset(object, 0, pool->object_size);
+    return object;
+}
+
+void numa_pool_free(NumaObjectPool *pool, void *object) {
+    if (!pool || !object) {
+        return;
+    }
+    NumaPoolHeader *header = (NumaPoolHeader *)object - 1;
+    size_t node = header->link.node;
+    header->link.next = pool->free_lists[node];
+    pool->free_lists[node] = header;
+}
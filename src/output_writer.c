@@ -1,21 +1,274 @@
 #include "output_writer.h"
 
+#include <fcntl.h>
+#include <limits.h>
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define OUTPUT_SEGMENT_MIN_CAPACITY 256u
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+void output_block_init(OutputBlock *block) {
+    if (!block) {
+        return;
+    }
+    block->segments = NULL;
+    block->count = 0;
+    block->capacity = 0;
+    block->sequence = 0;
+    block->next = NULL;
+}
+
+void output_block_free(OutputBlock *block) {
+    if (!block) {
+        return;
+    }
+    for (size_t i = 0; i < block->count; ++i) {
+        free(block->segments[i].data);
+    }
+    free(block->segments);
+    output_block_init(block);
+}
+
+// Returns a segment for `targets` with at least `extra` free bytes.
+static OutputSegment *reserve_segment(OutputBlock *block, unsigned targets, size_t extra) {
+    OutputSegment *segment = block->count ? &block->segments[block->count - 1] : NULL;
+    if (!segment || segment->targets != targets) {
+        if (block->count == block->capacity) {
+            size_t new_capacity = block->capacity ? block->capacity * 2 : 4;
+            OutputSegment *resized = (OutputSegment *)realloc(block->segments, new_capacity * sizeof(OutputSegment));
+            if (!resized) {
+                return NULL;
+            }
+            block->segments = resized;
+            block->capacity = new_capacity;
+        }
+        segment = &block->segments[block->count++];
+        segment->data = NULL;
+        segment->length = 0;
+        segment->capacity = 0;
+        segment->targets = targets;
+    }
+    if (segment->capacity - segment->length < extra) {
+        size_t new_capacity = segment->capacity ? segment->capacity * 2 : OUTPUT_SEGMENT_MIN_CAPACITY;
+        while (new_capacity - segment->length < extra) {
+            new_capacity *= 2;
+        }
+        char *resized = (char *)realloc(segment->data, new_capacity);
+        if (!resized) {
+            return NULL;
+        }
+        segment->data = resized;
+        segment->capacity = new_capacity;
+    }
+    return segment;
+}
+
+int output_block_append(OutputBlock *block, unsigned targets, const char *text) {
+    if (!block || !text) {
+        return -1;
+    }
+    size_t length = strlen(text);
+    OutputSegment *segment = reserve_segment(block, targets, length);
+    if (!segment) {
+        return -1;
+    }
+    memcpy(segment->data + segment->length, text, length);
+    segment->length += length;
+    return 0;
+}
+
+int output_block_appendf(OutputBlock *block, unsigned targets, const char *format, ...) {
+    if (!block || !format) {
+        return -1;
+    }
+    OutputSegment *segment = reserve_segment(block, targets, 128);
+    if (!segment) {
+        return -1;
+    }
+    va_list args;
+    va_start(args, format);
+    size_t available = segment->capacity - segment->length;
+    int length = vsnprintf(segment->data + segment->length, available, format, args);
+    va_end(args);
+    if (length < 0) {
+        return -1;
+    }
+    if ((size_t)length >= available) {
+        segment = reserve_segment(block, targets, (size_t)length + 1);
+        if (!segment) {
+            return -1;
+        }
+        va_start(args, format);
+        vsnprintf(segment->data + segment->length, (size_t)length + 1, format, args);
+        va_end(args);
+    }
+    segment->length += (size_t)length;
+    return 0;
+}
+
+// Takes ownership of a malloc'd buffer and appends it as its own segment.
+int output_block_attach(OutputBlock *block, unsigned targets, char *data, size_t length) {
+    if (!block || !data) {
+        return -1;
+    }
+    if (block->count == block->capacity) {
+        size_t new_capacity = block->capacity ? block->capacity * 2 : 4;
+        OutputSegment *resized = (OutputSegment *)realloc(block->segments, new_capacity * sizeof(OutputSegment));
+        if (!resized) {
+            free(data);
+            return -1;
+        }
+        block->segments = resized;
+        block->capacity = new_capacity;
+    }
+    OutputSegment *segment = &block->segments[block->count++];
+    segment->data = data;
+    segment->length = length;
+    segment->capacity = length;
+    segment->targets = targets;
+    return 0;
+}
+
+static void writev_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            return;
+        }
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= (ssize_t)iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= (size_t)written;
+        }
+    }
+}
+
+// Writes every segment of `blocks` addressed to `target` with as few writev calls as possible.
+static void write_blocks(int fd, const OutputBlock *blocks, unsigned target) {
+    struct iovec iov[IOV_MAX < 1024 ? IOV_MAX : 1024];
+    int count = 0;
+    for (const OutputBlock *block = blocks; block; block = block->next) {
+        for (size_t i = 0; i < block->count; ++i) {
+            const OutputSegment *segment = &block->segments[i];
+            if (!(segment->targets & target) || segment->length == 0) {
+                continue;
+            }
+            if (count == (int)(sizeof(iov) / sizeof(iov[0]))) {
+                writev_all(fd, iov, count);
+                count = 0;
+            }
+            iov[count].iov_base = segment->data;
+            iov[count].iov_len = segment->length;
+            ++count;
+        }
+    }
+    if (count > 0) {
+        writev_all(fd, iov, count);
+    }
+}
+
+// Console text bypasses stdio; flush anything printf left buffered so the
+// two streams do not interleave out of order.
+static void flush_stdio_for(int fd) {
+    if (fd == STDOUT_FILENO) {
+        fflush(stdout);
+    }
+}
+
+void output_block_write(const OutputBlock *block, int fd, unsigned target) {
+    if (!block || fd < 0) {
+        return;
+    }
+    OutputBlock single = *block;
+    single.next = NULL;
+    flush_stdio_for(fd);
+    write_blocks(fd, &single, target);
+}
+
+static void write_and_free_blocks(OutputWriter *writer, OutputBlock *batch) {
+    write_blocks(writer->fd, batch, OUTPUT_TO_FILE);
+    flush_stdio_for(writer->console_fd);
+    write_blocks(writer->console_fd, batch, OUTPUT_TO_CONSOLE);
+    while (batch) {
+        OutputBlock *next = batch->next;
+        output_block_free(batch);
+        free(batch);
+        batch = next;
+    }
+}
+
+// Parked in place of a block that could not be queued; its sequence is
+// written as empty output.
+static OutputBlock dropped_block;
+
+// Unlinks the run of consecutive blocks starting at next_sequence; caller holds the mutex.
+static OutputBlock *take_ready_blocks(OutputWriter *writer) {
+    OutputBlock *head = NULL;
+    OutputBlock *tail = NULL;
+    while (writer->pending_capacity > 0) {
+        OutputBlock **slot = &writer->pending[writer->next_sequence % writer->pending_capacity];
+        if (!*slot) {
+            break;
+        }
+        OutputBlock *block = *slot;
+        *slot = NULL;
+        ++writer->next_sequence;
+        if (block == &dropped_block) {
+            continue;
+        }
+        block->next = NULL;
+        if (tail) {
+            tail->next = block;
+        } else {
+            head = block;
+        }
+        tail = block;
+    }
+    return head;
+}
 
 int output_writer_init(OutputWriter *writer, const char *path) {
     if (!writer || !path) {
         return -1;
     }
-    writer->fp = fopen(path, "w");
-    if (!writer->fp) {
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0) {
+        return -1;
+    }
+    writer->pending = (OutputBlock **)calloc(OUTPUT_REORDER_CAPACITY, sizeof(OutputBlock *));
+    if (!writer->pending) {
+        close(writer->fd);
+        writer->fd = -1;
         return -1;
     }
     if (pthread_mutex_init(&writer->mutex, NULL) != 0) {
-        fclose(writer->fp);
-        writer->fp = NULL;
+        free(writer->pending);
+        close(writer->fd);
+        writer->fd = -1;
+        return -1;
+    }
+    if (pthread_cond_init(&writer->advanced, NULL) != 0) {
+        pthread_mutex_destroy(&writer->mutex);
+        free(writer->pending);
+        close(writer->fd);
+        writer->fd = -1;
         return -1;
     }
+    writer->console_fd = STDOUT_FILENO;
+    writer->pending_capacity = OUTPUT_REORDER_CAPACITY;
+    writer->next_sequence = 0;
+    writer->writing = 0;
     return 0;
 }
 
@@ -23,35 +276,84 @@ void output_writer_close(OutputWriter *writer) {
     if (!writer) {
         return;
     }
-    if (writer->fp) {
-        fflush(writer->fp);
-        fclose(writer->fp);
-        writer->fp = NULL;
+    // Flush blocks stranded behind a sequence number that was never committed.
+    for (size_t scanned = 0; scanned < writer->pending_capacity;) {
+        OutputBlock *ready = take_ready_blocks(writer);
+        if (ready) {
+            write_and_free_blocks(writer, ready);
+            scanned = 0;
+        } else {
+            ++writer->next_sequence;
+            ++scanned;
+        }
     }
+    free(writer->pending);
+    writer->pending = NULL;
+    writer->pending_capacity = 0;
+    if (writer->fd >= 0) {
+        close(writer->fd);
+        writer->fd = -1;
+    }
+    pthread_cond_destroy(&writer->advanced);
     pthread_mutex_destroy(&writer->mutex);
 }
 
-int output_writer_append(OutputWriter *writer, const char *text) {
-    if (!writer || !writer->fp || !text) {
+// Parks the block in the reorder buffer; whichever committer finds the writer
+// idle writes out every block whose predecessors are already written, so
+// blocks land contiguously and in sequence order. A committer more than
+// OUTPUT_REORDER_CAPACITY ahead waits for the window to advance, which bounds
+// the memory held by blocks that cannot be written yet.
+int output_writer_commit(OutputWriter *writer, size_t sequence, OutputBlock *block) {
+    if (!writer || writer->fd < 0 || !block) {
         return -1;
     }
-    pthread_mutex_lock(&writer->mutex);
-    fputs(text, writer->fp);
-    fflush(writer->fp);
-    pthread_mutex_unlock(&writer->mutex);
-    return 0;
-}
+    int status = 0;
+    OutputBlock *queued = (OutputBlock *)malloc(sizeof(OutputBlock));
+    if (queued) {
+        *queued = *block;
+        queued->sequence = sequence;
+        queued->next = NULL;
+        output_block_init(block);
+    } else {
+        output_block_free(block);
+        queued = &dropped_block;
+        status = -1;
+    }
 
-int output_writer_appendf(OutputWriter *writer, const char *format, ...) {
-    if (!writer || !writer->fp || !format) {
+    pthread_mutex_lock(&writer->mutex);
+    if (sequence < writer->next_sequence) {
+        pthread_mutex_unlock(&writer->mutex);
+        if (queued != &dropped_block) {
+            output_block_free(queued);
+            free(queued);
+        }
         return -1;
     }
-    pthread_mutex_lock(&writer->mutex);
-    va_list args;
-    va_start(args, format);
-    vfprintf(writer->fp, format, args);
-    va_end(args);
-    fflush(writer->fp);
+    while (sequence - writer->next_sequence >= writer->pending_capacity) {
+        pthread_cond_wait(&writer->advanced, &writer->mutex);
+    }
+    writer->pending[sequence % writer->pending_capacity] = queued;
+    if (writer->writing) {
+        pthread_mutex_unlock(&writer->mutex);
+        return status;
+    }
+    writer->writing = 1;
+    size_t written_up_to = writer->next_sequence;
+    OutputBlock *batch;
+    for (;;) {
+        batch = take_ready_blocks(writer);
+        if (writer->next_sequence != written_up_to) {
+            written_up_to = writer->next_sequence;
+            pthread_cond_broadcast(&writer->advanced);
+        }
+        if (!batch) {
+            break;
+        }
+        pthread_mutex_unlock(&writer->mutex);
+        write_and_free_blocks(writer, batch);
+        pthread_mutex_lock(&writer->mutex);
+    }
+    writer->writing = 0;
     pthread_mutex_unlock(&writer->mutex);
-    return 0;
+    return status;
 }
@@ -0,0 +1,130 @@
+#include "record_format.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FORMAT_CHUNK_MIN_RECORDS 16384u
+#define FORMAT_MAX_CHUNKS 16
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static size_t format_u32(char *out, uint32_t value) {
+    char digits[10];
+    size_t position = sizeof(digits);
+    while (value >= 100) {
+        uint32_t pair = (value % 100) * 2;
+        value /= 100;
+        digits[--position] = digit_pairs[pair + 1];
+        digits[--position] = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        digits[--position] = digit_pairs[value * 2 + 1];
+        digits[--position] = digit_pairs[value * 2];
+    } else {
+        digits[--position] = (char)('0' + value);
+    }
+    size_t length = sizeof(digits) - position;
+    memcpy(out, digits + position, length);
+    return length;
+}
+
+// Equivalent to sprintf(out, "%u,%s,%u\n", ...) without the NUL terminator.
+size_t format_record_line(char *out, const hashRecord *record) {
+    size_t length = format_u32(out, record->hash);
+    out[length++] = ',';
+    size_t name_length = strnlen(record->name, HASH_NAME_MAX);
+    memcpy(out + length, record->name, name_length);
+    length += name_length;
+    out[length++] = ',';
+    length += format_u32(out + length, record->salary);
+    out[length++] = '\n';
+    return length;
+}
+
+typedef struct {
+    const hashRecord *records;
+    size_t count;
+    char *data;
+    size_t length;
+} FormatChunk;
+
+static void *format_chunk(void *arg) {
+    FormatChunk *chunk = (FormatChunk *)arg;
+    chunk->data = (char *)malloc(chunk->count * RECORD_LINE_MAX);
+    if (!chunk->data) {
+        return NULL;
+    }
+    char *cursor = chunk->data;
+    for (size_t i = 0; i < chunk->count; ++i) {
+        cursor += format_record_line(cursor, &chunk->records[i]);
+    }
+    chunk->length = (size_t)(cursor - chunk->data);
+    return NULL;
+}
+
+// Formats the records in parallel chunks and attaches them to `block` in order.
+int append_record_listing(OutputBlock *block, unsigned targets, const hashRecord *records, size_t count) {
+    if (!block || (!records && count > 0)) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    size_t chunk_count = count / FORMAT_CHUNK_MIN_RECORDS;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0 && chunk_count > (size_t)cpus) {
+        chunk_count = (size_t)cpus;
+    }
+    if (chunk_count > FORMAT_MAX_CHUNKS) {
+        chunk_count = FORMAT_MAX_CHUNKS;
+    }
+    if (chunk_count == 0) {
+        chunk_count = 1;
+    }
+
+    FormatChunk chunks[FORMAT_MAX_CHUNKS];
+    pthread_t threads[FORMAT_MAX_CHUNKS];
+    int thread_created[FORMAT_MAX_CHUNKS] = {0};
+    size_t per_chunk = count / chunk_count;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        chunks[i].records = records + i * per_chunk;
+        chunks[i].count = i + 1 == chunk_count ? count - i * per_chunk : per_chunk;
+        chunks[i].data = NULL;
+        chunks[i].length = 0;
+    }
+    for (size_t i = 1; i < chunk_count; ++i) {
+        thread_created[i] = pthread_create(&threads[i], NULL, format_chunk, &chunks[i]) == 0;
+        if (!thread_created[i]) {
+            format_chunk(&chunks[i]);
+        }
+    }
+    format_chunk(&chunks[0]);
+    for (size_t i = 1; i < chunk_count; ++i) {
+        if (thread_created[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    int status = 0;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        if (status == 0 && chunks[i].data) {
+            status = output_block_attach(block, targets, chunks[i].data, chunks[i].length);
+        } else {
+            status = -1;
+            free(chunks[i].data);
+        }
+    }
+    return status;
+}
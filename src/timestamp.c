@@ -1,9 +1,169 @@
 #include "timestamp.h"
 
-#include <sys/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TIMESTAMP_HAVE_TSC 1
+#endif
+
+#define TSC_CALIBRATION_NANOSECONDS 10000000ull
+#define TSC_MIN_HZ 100000000.0
+#define TSC_FRACTION_BITS 32
+#define KERNEL_CLOCKSOURCE_PATH "/sys/devices/system/clocksource/clocksource0/current_clocksource"
+
+static int clock_initialized;
+static ClockSource clock_source = CLOCK_SOURCE_MONOTONIC;
+static clockid_t clock_id = CLOCK_MONOTONIC;
+static uint64_t anchor_monotonic_ns;
+static long long anchor_wall_us;
+#ifdef TIMESTAMP_HAVE_TSC
+static uint64_t tsc_base;
+static uint64_t tsc_base_ns;
+static uint64_t tsc_ns_per_tick; // fixed point, TSC_FRACTION_BITS fraction bits
+#endif
+
+static uint64_t clock_nanoseconds(clockid_t id) {
+    struct timespec now;
+    clock_gettime(id, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+#ifdef TIMESTAMP_HAVE_TSC
+static int tsc_is_invariant(void) {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx) || eax < 0x80000007u) {
+        return 0;
+    }
+    __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+}
+
+// The kernel demotes the TSC from its clocksource when it finds it unstable
+// (e.g. cross-socket skew); follow that verdict when it is available.
+static int kernel_trusts_tsc(void) {
+    FILE *fp = fopen(KERNEL_CLOCKSOURCE_PATH, "r");
+    if (!fp) {
+        return 1;
+    }
+    char name[32] = {0};
+    int trusted = fgets(name, sizeof(name), fp) == NULL || strncmp(name, "tsc", 3) == 0;
+    fclose(fp);
+    return trusted;
+}
+
+// Measures the TSC rate against CLOCK_MONOTONIC; returns -1 if it looks implausible.
+static int calibrate_tsc(void) {
+    uint64_t start_ns = clock_nanoseconds(CLOCK_MONOTONIC);
+    uint64_t start_tsc = __rdtsc();
+    uint64_t end_ns;
+    do {
+        end_ns = clock_nanoseconds(CLOCK_MONOTONIC);
+    } while (end_ns - start_ns < TSC_CALIBRATION_NANOSECONDS);
+    uint64_t end_tsc = __rdtsc();
+    if (end_tsc <= start_tsc) {
+        return -1;
+    }
+    double hz = (double)(end_tsc - start_tsc) * 1e9 / (double)(end_ns - start_ns);
+    if (hz < TSC_MIN_HZ) {
+        return -1;
+    }
+    tsc_ns_per_tick = (uint64_t)(1e9 / hz * (double)(1ull << TSC_FRACTION_BITS));
+    tsc_base = end_tsc;
+    tsc_base_ns = end_ns;
+    return 0;
+}
+#endif
+
+static uint64_t read_clock(void) {
+#ifdef TIMESTAMP_HAVE_TSC
+    if (clock_source == CLOCK_SOURCE_TSC) {
+        uint64_t now = __rdtsc();
+        if (now <= tsc_base) {
+            return tsc_base_ns; // tolerate small cross-core skew around the base
+        }
+        __extension__ unsigned __int128 ticks = now - tsc_base;
+        return tsc_base_ns + (uint64_t)((ticks * tsc_ns_per_tick) >> TSC_FRACTION_BITS);
+    }
+#endif
+    return clock_nanoseconds(clock_id);
+}
+
+static ClockSource requested_source(void) {
+    const char *requested = getenv("CHASH_CLOCK");
+    if (requested && strcmp(requested, "monotonic") == 0) {
+        return CLOCK_SOURCE_MONOTONIC;
+    }
+    if (requested && strcmp(requested, "coarse") == 0) {
+        return CLOCK_SOURCE_MONOTONIC_COARSE;
+    }
+    return CLOCK_SOURCE_TSC;
+}
+
+static void initialize_clock(void) {
+    ClockSource source = requested_source();
+    if (source == CLOCK_SOURCE_TSC) {
+        source = CLOCK_SOURCE_MONOTONIC;
+#ifdef TIMESTAMP_HAVE_TSC
+        // Only spend the calibration busy-wait when the TSC can actually be used.
+        if (tsc_is_invariant() && kernel_trusts_tsc() && calibrate_tsc() == 0) {
+            source = CLOCK_SOURCE_TSC;
+        }
+#endif
+    }
+#ifdef CLOCK_MONOTONIC_COARSE
+    if (source == CLOCK_SOURCE_MONOTONIC_COARSE) {
+        clock_id = CLOCK_MONOTONIC_COARSE;
+    }
+#else
+    if (source == CLOCK_SOURCE_MONOTONIC_COARSE) {
+        source = CLOCK_SOURCE_MONOTONIC;
+    }
+#endif
+    clock_source = source;
+
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+    anchor_monotonic_ns = read_clock();
+    anchor_wall_us = (long long)wall.tv_sec * 1000000LL + wall.tv_nsec / 1000;
+}
+
+void timestamp_init(void) {
+    if (!clock_initialized) {
+        initialize_clock();
+        clock_initialized = 1;
+    }
+}
+
+ClockSource timestamp_clock_source(void) {
+    return clock_source;
+}
+
+const char *timestamp_clock_source_name(void) {
+    switch (timestamp_clock_source()) {
+        case CLOCK_SOURCE_TSC:
+            return "tsc";
+        case CLOCK_SOURCE_MONOTONIC_COARSE:
+            return "monotonic_coarse";
+        case CLOCK_SOURCE_MONOTONIC:
+        default:
+            return "monotonic";
+    }
+}
 
 long long current_timestamp_microseconds(void) {
-    struct timeval te;
-    gettimeofday(&te, NULL);
-    return (long long)te.tv_sec * 1000000LL + te.tv_usec;
+    // Signed: a reading on a core whose TSC trails the anchor's must not wrap.
+    int64_t elapsed_ns = (int64_t)(read_clock() - anchor_monotonic_ns);
+    if (elapsed_ns < 0) {
+        elapsed_ns = 0;
+    }
+    return anchor_wall_us + (long long)(elapsed_ns / 1000);
+}
+
+uint64_t monotonic_nanoseconds(void) {
+    return read_clock();
 }
@@ -0,0 +1,55 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Minimal assertion helpers shared by the unit tests; a failed check reports
+// and keeps going so one run shows every broken expectation.
+static int check_failures;
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++check_failures;                                                             \
+        }                                                                                 \
+    } while (0)
+
+static inline int check_finish(const char *name) {
+    printf("%s: %s\n", name, check_failures ? "FAILED" : "ok");
+    return check_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Creates an empty scratch file and copies its path into `path`.
+static inline int check_temp_path(char *path, size_t size, const char *stem) {
+    const char *directory = getenv("TMPDIR");
+    snprintf(path, size, "%s/%s-XXXXXX", directory && directory[0] ? directory : "/tmp", stem);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+// Reads a whole file into a NUL-terminated malloc'd buffer.
+static inline char *check_read_file(const char *path, size_t *length) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *data = (char *)malloc((size_t)size + 1);
+    if (data) {
+        *length = fread(data, 1, (size_t)size, fp);
+        data[*length] = '\0';
+    }
+    fclose(fp);
+    return data;
+}
+
+#endif // CHECK_H
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+#include "hash_table.h"
+
+#define DIFF_KEYS 3000
+#define DIFF_OPERATIONS 60000
+#define HOT_KEYS 50
+
+static void key_name(char *name, size_t size, int key) {
+    snprintf(name, size, "k%d", key);
+}
+
+static int is_resident(const HashTable *table, const char *name) {
+    for (const hashRecord *node = table->head; node; node = node->next) {
+        if (strcmp(node->name, name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int same_records(HashTable *tiered, HashTable *plain) {
+    size_t tiered_count = 0;
+    size_t plain_count = 0;
+    hashRecord *a = hash_table_clone_records(tiered, &tiered_count);
+    hashRecord *b = hash_table_clone_records(plain, &plain_count);
+    int same = tiered_count == plain_count;
+    for (size_t i = 0; same && i < tiered_count; ++i) {
+        same = a[i].hash == b[i].hash && a[i].salary == b[i].salary && strcmp(a[i].name, b[i].name) == 0;
+    }
+    free(a);
+    free(b);
+    return same;
+}
+
+// A capped table must answer every operation exactly like an uncapped one.
+static void check_differential(size_t memory_cap) {
+    HashTable tiered;
+    HashTable plain;
+    hash_table_init(&tiered);
+    hash_table_init(&plain);
+    CHECK(hash_table_enable_tiering(&tiered, memory_cap, NULL) == 0);
+    srand(7);
+    char name[32];
+    int mismatches = 0;
+    for (int i = 0; i < DIFF_OPERATIONS && mismatches == 0; ++i) {
+        int operation = rand() % 10;
+        key_name(name, sizeof(name), rand() % DIFF_KEYS);
+        uint32_t hash = jenkins_one_at_a_time_hash(name);
+        if (operation < 4) {
+            uint32_t salary = (uint32_t)rand();
+            uint32_t tiered_previous = 0;
+            uint32_t plain_previous = 0;
+            int tiered_updated = 0;
+            int plain_updated = 0;
+            hash_table_insert_locked(&tiered, name, salary, hash, &tiered_previous, &tiered_updated);
+            hash_table_insert_locked(&plain, name, salary, hash, &plain_previous, &plain_updated);
+            mismatches += tiered_previous != plain_previous || tiered_updated != plain_updated;
+        } else if (operation < 6) {
+            uint32_t tiered_removed = 0;
+            uint32_t plain_removed = 0;
+            int tiered_status = hash_table_delete_locked(&tiered, name, hash, &tiered_removed);
+            int plain_status = hash_table_delete_locked(&plain, name, hash, &plain_removed);
+            mismatches += tiered_status != plain_status || tiered_removed != plain_removed;
+        } else {
+            hashRecord *a = hash_table_find(&tiered, name, hash);
+            hashRecord *b = hash_table_find(&plain, name, hash);
+            mismatches += !a != !b || (a && a->salary != b->salary);
+        }
+        if (i % 10000 == 0) {
+            mismatches += !same_records(&tiered, &plain);
+        }
+    }
+    CHECK(mismatches == 0);
+    CHECK(same_records(&tiered, &plain));
+    HashTableStats stats;
+    hash_table_collect_stats(&tiered, &stats);
+    CHECK(stats.evictions > 0);
+    CHECK(stats.resident_records + stats.cold_records == stats.records);
+    hash_table_destroy(&tiered);
+    hash_table_destroy(&plain);
+}
+
+// Spilled records read repeatedly are promoted back by the next writer.
+static void check_promotion(void) {
+    HashTable table;
+    hash_table_init(&table);
+    CHECK(hash_table_enable_tiering(&table, 80000, NULL) == 0);
+    char name[32];
+    for (int key = 0; key < DIFF_KEYS; ++key) {
+        key_name(name, sizeof(name), key);
+        hash_table_insert_locked(&table, name, (uint32_t)key, jenkins_one_at_a_time_hash(name), NULL, NULL);
+    }
+    HashTableStats stats;
+    hash_table_collect_stats(&table, &stats);
+    CHECK(stats.cold_records > 0);
+    int spilled = 0;
+    for (int key = 0; key < HOT_KEYS; ++key) {
+        key_name(name, sizeof(name), key);
+        spilled += !is_resident(&table, name);
+    }
+    CHECK(spilled > 0);
+    for (unsigned round = 0; round < COLD_PROMOTE_READS; ++round) {
+        for (int key = 0; key < HOT_KEYS; ++key) {
+            key_name(name, sizeof(name), key);
+            hashRecord *record = hash_table_find(&table, name, jenkins_one_at_a_time_hash(name));
+            CHECK(record && record->salary == (uint32_t)key);
+        }
+    }
+    hash_table_delete_locked(&table, "absent", jenkins_one_at_a_time_hash("absent"), NULL);
+    int resident = 0;
+    for (int key = 0; key < HOT_KEYS; ++key) {
+        key_name(name, sizeof(name), key);
+        resident += is_resident(&table, name);
+    }
+    CHECK(resident == HOT_KEYS);
+    hash_table_collect_stats(&table, &stats);
+    CHECK(stats.promotions >= (uint64_t)spilled);
+    hash_table_destroy(&table);
+}
+
+int main(void) {
+    check_differential(hash_table_min_memory_cap() + 8192);
+    check_differential(60000);
+    check_promotion();
+    return check_finish("test_cold_tier");
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+#include "command_stream.h"
+
+// Rewrites the file at `path` after letting `mutate` edit its bytes.
+static void rewrite(const char *path, const char *source, void (*mutate)(unsigned char *, size_t *)) {
+    size_t length = 0;
+    char *data = check_read_file(source, &length);
+    if (!data) {
+        return;
+    }
+    data = (char *)realloc(data, length + 1);
+    mutate((unsigned char *)data, &length);
+    FILE *fp = fopen(path, "wb");
+    if (fp) {
+        fwrite(data, 1, length, fp);
+        fclose(fp);
+    }
+    free(data);
+}
+
+static void flip_hash_bit(unsigned char *data, size_t *length) {
+    // The last record is SEARCH "carol": hash, length byte, then 5 name bytes.
+    data[*length - 10] ^= 1;
+}
+
+static void append_byte(unsigned char *data, size_t *length) {
+    data[(*length)++] = 0;
+}
+
+int main(void) {
+    Command commands[3];
+    memset(commands, 0, sizeof(commands));
+    const char *names[3] = {"alice", "bob", "carol"};
+    CommandType types[3] = {COMMAND_INSERT, COMMAND_DELETE, COMMAND_SEARCH};
+    for (int i = 0; i < 3; ++i) {
+        commands[i].type = types[i];
+        commands[i].priority = (uint32_t)(i * 300);
+        commands[i].salary = i == 0 ? 70000 : 0;
+        strcpy(commands[i].name, names[i]);
+        commands[i].hash = jenkins_one_at_a_time_hash(names[i]);
+    }
+    CommandList list = {commands, 3, 3};
+
+    char path[256];
+    char broken[256];
+    char error[128];
+    CHECK(check_temp_path(path, sizeof(path), "chash-test-stream") == 0);
+    CHECK(check_temp_path(broken, sizeof(broken), "chash-test-stream") == 0);
+    CHECK(command_stream_write(path, &list, error, sizeof(error)) == 0);
+    CHECK(command_stream_is_binary(path));
+
+    CommandList loaded;
+    CHECK(command_stream_load(path, &loaded, error, sizeof(error)) == 0);
+    CHECK(loaded.size == 3);
+    for (size_t i = 0; i < loaded.size && i < 3; ++i) {
+        CHECK(loaded.items[i].type == commands[i].type && loaded.items[i].priority == commands[i].priority);
+        CHECK(loaded.items[i].salary == commands[i].salary && loaded.items[i].hash == commands[i].hash);
+        CHECK(strcmp(loaded.items[i].name, commands[i].name) == 0);
+    }
+    free_command_list(&loaded);
+
+    rewrite(broken, path, flip_hash_bit);
+    CHECK(command_stream_load(broken, &loaded, error, sizeof(error)) == -1);
+    CHECK(strstr(error, "Checksum mismatch") != NULL);
+    CHECK(loaded.items == NULL);
+
+    rewrite(broken, path, append_byte);
+    CHECK(command_stream_load(broken, &loaded, error, sizeof(error)) == -1);
+    CHECK(strstr(error, "Checksum mismatch") != NULL);
+
+    unlink(path);
+    unlink(broken);
+    return check_finish("test_command_stream");
+}
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "commands.h"
+
+#define LINES 500
+#define BAD_LINE 437
+
+// Line n is a comment every 7th line, blank every 11th, else a command whose
+// priority is n, so a loaded list shows exactly which lines survived.
+static void write_lines(const char *path, int bad_line, int final_newline) {
+    FILE *fp = fopen(path, "w");
+    for (int line = 1; line <= LINES; ++line) {
+        if (line == bad_line) {
+            fprintf(fp, "insert,broken,notanumber,%d", line);
+        } else if (line % 7 == 0) {
+            fprintf(fp, "# comment %d", line);
+        } else if (line % 11 == 0) {
+            fprintf(fp, "   ");
+        } else if (line % 3 == 0) {
+            fprintf(fp, "search,name-%d,%d", line, line);
+        } else {
+            fprintf(fp, "insert,name-%d,%d,%d", line, line * 10, line);
+        }
+        if (line < LINES || final_newline) {
+            fputc('\n', fp);
+        }
+    }
+    fclose(fp);
+}
+
+static int expected_command(int line) {
+    return line % 7 != 0 && line % 11 != 0;
+}
+
+static int list_matches(const CommandList *list) {
+    size_t index = 0;
+    for (int line = 1; line <= LINES; ++line) {
+        if (!expected_command(line)) {
+            continue;
+        }
+        if (index >= list->size) {
+            return 0;
+        }
+        const Command *command = &list->items[index++];
+        char name[32];
+        snprintf(name, sizeof(name), "name-%d", line);
+        if (command->priority != (uint32_t)line || strcmp(command->name, name) != 0) {
+            return 0;
+        }
+        if (command->type != (line % 3 == 0 ? COMMAND_SEARCH : COMMAND_INSERT)) {
+            return 0;
+        }
+        if (command->hash != jenkins_one_at_a_time_hash(name)) {
+            return 0;
+        }
+    }
+    return index == list->size;
+}
+
+int main(void) {
+    char path[256];
+    char error[160];
+    CHECK(check_temp_path(path, sizeof(path), "chash-test-commands") == 0);
+    const size_t chunk_counts[] = {1, 2, 3, 7, 64, 1000};
+
+    // Every split yields the same commands in file order, with or without a
+    // final newline.
+    for (int final_newline = 0; final_newline < 2; ++final_newline) {
+        write_lines(path, 0, final_newline);
+        for (size_t i = 0; i < sizeof(chunk_counts) / sizeof(chunk_counts[0]); ++i) {
+            CommandList list;
+            CHECK(load_commands_chunked(path, &list, chunk_counts[i], error, sizeof(error)) == 0);
+            CHECK(list_matches(&list));
+            free_command_list(&list);
+        }
+    }
+
+    // A parse error names its line in the whole file, not within its chunk.
+    write_lines(path, BAD_LINE, 1);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "Line %d: ", BAD_LINE);
+    for (size_t i = 0; i < sizeof(chunk_counts) / sizeof(chunk_counts[0]); ++i) {
+        CommandList list;
+        error[0] = '\0';
+        CHECK(load_commands_chunked(path, &list, chunk_counts[i], error, sizeof(error)) == -1);
+        CHECK(strncmp(error, expected, strlen(expected)) == 0);
+        CHECK(list.items == NULL && list.size == 0);
+    }
+
+    // An empty file loads as an empty list.
+    FILE *fp = fopen(path, "w");
+    fclose(fp);
+    CommandList empty;
+    CHECK(load_commands_chunked(path, &empty, 4, error, sizeof(error)) == 0);
+    CHECK(empty.size == 0);
+    free_command_list(&empty);
+
+    unlink(path);
+    return check_finish("test_commands");
+}
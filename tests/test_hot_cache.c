@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "check.h"
+#include "hash_table.h"
+#include "hot_cache.h"
+
+#define TIERED_KEYS 3000
+#define SEARCH_EVERY 100
+
+static uint32_t insert(HashTable *table, const char *name, uint32_t salary) {
+    uint32_t hash = jenkins_one_at_a_time_hash(name);
+    hash_table_insert_locked(table, name, salary, hash, NULL, NULL);
+    return hash;
+}
+
+// SEARCH as the command processor runs it: the cache first, then the table,
+// refilling the cache on a table hit.
+static int cached_search(HotKeyCache *cache, HashTable *table, const char *name, uint32_t *salary) {
+    uint32_t hash = jenkins_one_at_a_time_hash(name);
+    if (hot_cache_lookup(cache, table, hash, name, salary)) {
+        return 1;
+    }
+    hashRecord *record = hash_table_find(table, name, hash);
+    if (!record) {
+        return 0;
+    }
+    *salary = record->salary;
+    hot_cache_store(cache, table, hash, name, record->salary);
+    return 1;
+}
+
+static int is_resident(const HashTable *table, const char *name) {
+    for (const hashRecord *node = table->head; node; node = node->next) {
+        if (strcmp(node->name, name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    static HotKeyCache cache;
+    hot_cache_init(&cache);
+    HashTable table;
+    hash_table_init(&table);
+    uint32_t salary = 0;
+
+    uint32_t hash = insert(&table, "alice", 100);
+    CHECK(!hot_cache_lookup(&cache, &table, hash, "alice", &salary));
+    hot_cache_store(&cache, &table, hash, "alice", 100);
+    CHECK(hot_cache_lookup(&cache, &table, hash, "alice", &salary) && salary == 100);
+    CHECK(!hot_cache_lookup(&cache, &table, hash, "alicf", &salary));
+
+    // Any write to the key bumps its stripe version and invalidates the entry.
+    insert(&table, "alice", 200);
+    CHECK(!hot_cache_lookup(&cache, &table, hash, "alice", &salary));
+    hot_cache_store(&cache, &table, hash, "alice", 200);
+    CHECK(hot_cache_lookup(&cache, &table, hash, "alice", &salary) && salary == 200);
+    CHECK(hash_table_delete_locked(&table, "alice", hash, NULL) == 1);
+    CHECK(!hot_cache_lookup(&cache, &table, hash, "alice", &salary));
+
+    // A moved access epoch sends the lookup back to the table.
+    hash = insert(&table, "bob", 300);
+    hot_cache_store(&cache, &table, hash, "bob", 300);
+    CHECK(hot_cache_lookup(&cache, &table, hash, "bob", &salary));
+    atomic_fetch_add(&table.access_epoch, 1);
+    CHECK(!hot_cache_lookup(&cache, &table, hash, "bob", &salary));
+    CHECK(cache.hits == 3 && cache.misses == 5);
+    hash_table_destroy(&table);
+
+    // With tiering, a key served from the cache still counts as recently used,
+    // so a stream of newer writes does not spill it. The writes skip the hot
+    // key's version stripe, so only the epoch can send its lookups to the table.
+    hash_table_init(&table);
+    hot_cache_init(&cache);
+    CHECK(hash_table_enable_tiering(&table, 80000, NULL) == 0);
+    uint32_t hot_stripe = insert(&table, "hot", 7) % HASH_TABLE_VERSION_STRIPES;
+    CHECK(cached_search(&cache, &table, "hot", &salary) && salary == 7);
+    char name[32];
+    for (int key = 0; key < TIERED_KEYS; ++key) {
+        snprintf(name, sizeof(name), "k%d", key);
+        if (jenkins_one_at_a_time_hash(name) % HASH_TABLE_VERSION_STRIPES == hot_stripe) {
+            continue;
+        }
+        insert(&table, name, (uint32_t)key);
+        if (key % SEARCH_EVERY == 0) {
+            CHECK(cached_search(&cache, &table, "hot", &salary) && salary == 7);
+        }
+    }
+    HashTableStats stats;
+    hash_table_collect_stats(&table, &stats);
+    CHECK(stats.evictions > 0);
+    CHECK(cache.hits > 0);
+    CHECK(is_resident(&table, "hot"));
+    hash_table_destroy(&table);
+    return check_finish("test_hot_cache");
+}
@@ -0,0 +1,67 @@
+#include <stdint.h>
+
+#include "check.h"
+#include "latency_stats.h"
+
+static LatencyStats stats;
+
+// Upper bound of the bucket `value` lands in, read back through a percentile.
+static uint64_t bucket_upper(uint64_t value) {
+    LatencyHistogram histogram;
+    latency_histogram_reset(&histogram);
+    latency_histogram_record(&histogram, value);
+    latency_histogram_record(&histogram, UINT64_C(1) << 41); // lifts the max clamp
+    return latency_histogram_percentile(&histogram, 50.0);
+}
+
+int main(void) {
+    // Exact below 32 ns, then within one sub-bucket (1/16) above.
+    for (uint64_t value = 0; value < 32; ++value) {
+        CHECK(bucket_upper(value) == value);
+    }
+    for (uint64_t value = 32; value < (UINT64_C(1) << 39); value = value * 3 / 2 + 1) {
+        uint64_t upper = bucket_upper(value);
+        CHECK(upper >= value);
+        CHECK(upper - value <= value / 16);
+    }
+    for (unsigned shift = 5; shift < 39; ++shift) {
+        uint64_t base = UINT64_C(1) << shift;
+        CHECK(bucket_upper(base - 1) < bucket_upper(base));
+        CHECK(bucket_upper(base) == bucket_upper(base + base / 16 - 1));
+    }
+
+    LatencyHistogram histogram;
+    latency_histogram_reset(&histogram);
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        latency_histogram_record(&histogram, value);
+    }
+    CHECK(histogram.total == 1000 && histogram.max == 1000 && histogram.sum == 500500);
+    uint64_t median = latency_histogram_percentile(&histogram, 50.0);
+    CHECK(median >= 500 && median <= 500 + 500 / 16);
+    CHECK(latency_histogram_percentile(&histogram, 100.0) == 1000);
+    LatencyHistogram merged;
+    latency_histogram_reset(&merged);
+    latency_histogram_merge(&merged, &histogram);
+    latency_histogram_merge(&merged, &histogram);
+    CHECK(merged.total == 2000 && merged.sum == 1001000 && merged.max == 1000);
+
+    // Recorders flush into the shared atomic histograms when full and on demand.
+    CHECK(latency_stats_init(&stats) == 0);
+    LatencyRecorder recorder = {0};
+    for (uint64_t i = 1; i <= 3 * LATENCY_RECORDER_CAPACITY + 1; ++i) {
+        latency_recorder_add(&recorder, &stats, LATENCY_SEARCH, i * 100);
+    }
+    latency_recorder_add(&recorder, &stats, LATENCY_STATS, 7);
+    latency_recorder_flush(&recorder, &stats);
+    CHECK(recorder.count == 0);
+    LatencyHistogram snapshot;
+    latency_stats_snapshot(&stats, LATENCY_SEARCH, &snapshot);
+    CHECK(snapshot.total == 3 * LATENCY_RECORDER_CAPACITY + 1);
+    CHECK(snapshot.max == (3 * LATENCY_RECORDER_CAPACITY + 1) * 100);
+    latency_stats_snapshot(&stats, LATENCY_STATS, &snapshot);
+    CHECK(snapshot.total == 1 && snapshot.sum == 7);
+    latency_stats_snapshot(&stats, LATENCY_PRINT, &snapshot);
+    CHECK(snapshot.total == 0);
+    latency_stats_destroy(&stats);
+    return check_finish("test_latency_stats");
+}
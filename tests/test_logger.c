@@ -0,0 +1,98 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+#include "logger.h"
+#include "timestamp.h"
+
+#define PRODUCERS 4u
+// Several laps of the ring so every slot is reused while producers race.
+#define ENTRIES_PER_PRODUCER (LOGGER_RING_CAPACITY + 37u)
+
+typedef struct {
+    Logger *logger;
+    unsigned id;
+} Producer;
+
+static void *produce(void *arg) {
+    Producer *producer = (Producer *)arg;
+    for (unsigned i = 0; i < ENTRIES_PER_PRODUCER; ++i) {
+        logger_log_command(producer->logger, producer->id, "entry %u", i);
+    }
+    return NULL;
+}
+
+int main(void) {
+    timestamp_init();
+    char path[256];
+    CHECK(check_temp_path(path, sizeof(path), "chash-test-log") == 0);
+    Logger logger;
+    CHECK(logger_init(&logger, path) == 0);
+
+    pthread_t threads[PRODUCERS];
+    Producer producers[PRODUCERS];
+    for (unsigned t = 0; t < PRODUCERS; ++t) {
+        producers[t].logger = &logger;
+        producers[t].id = t;
+        CHECK(pthread_create(&threads[t], NULL, produce, &producers[t]) == 0);
+    }
+    for (unsigned t = 0; t < PRODUCERS; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+    logger_log_insert(&logger, 7, 4294967295u, "Jane Doe", 70000);
+    logger_log_delete(&logger, 8, 0, "Jane Doe");
+    logger_log_search(&logger, 9, 12345, "x");
+    logger_log_status(&logger, 0, "DONE");
+    logger_close(&logger);
+
+    size_t length = 0;
+    char *data = check_read_file(path, &length);
+    CHECK(data != NULL);
+    unsigned next[PRODUCERS] = {0};
+    size_t lines = 0;
+    unsigned typed = 0;
+    long long previous = 0;
+    int ordered = 1;
+    for (char *line = data ? strtok(data, "\n") : NULL; line; line = strtok(NULL, "\n")) {
+        long long timestamp = previous;
+        unsigned thread;
+        unsigned index;
+        ++lines;
+        if (sscanf(line, "%lld,THREAD %u,entry %u", &timestamp, &thread, &index) == 3) {
+            // One producer per id, so its entries must appear exactly once and in order.
+            CHECK(thread < PRODUCERS && index == next[thread]);
+            if (thread < PRODUCERS) {
+                next[thread] = index + 1;
+            }
+        } else {
+            // Keyed entries are formatted by the flusher from their raw fields.
+            static const char *const typed_lines[] = {",THREAD 7,INSERT,4294967295,Jane Doe,70000",
+                                                      ",THREAD 8,DELETE,0,Jane Doe", ",THREAD 9,SEARCH,12345,x",
+                                                      ",THREAD 0DONE"};
+            char *rest = strchr(line, ',');
+            int known = 0;
+            for (unsigned i = 0; rest && i < 4; ++i) {
+                if (strcmp(rest, typed_lines[i]) == 0) {
+                    CHECK(i == typed);
+                    ++typed;
+                    known = 1;
+                }
+            }
+            CHECK(known);
+            CHECK(sscanf(line, "%lld", &timestamp) == 1);
+        }
+        ordered = ordered && timestamp >= previous;
+        previous = timestamp;
+    }
+    CHECK(lines == PRODUCERS * ENTRIES_PER_PRODUCER + 4);
+    CHECK(typed == 4);
+    CHECK(ordered);
+    for (unsigned t = 0; t < PRODUCERS; ++t) {
+        CHECK(next[t] == ENTRIES_PER_PRODUCER);
+    }
+    free(data);
+    unlink(path);
+    return check_finish("test_logger");
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+
+#include "check.h"
+#include "hash_table.h"
+#include "membership_filter.h"
+
+#define KEYS 6000
+
+static void key_name(char *name, size_t size, int key) {
+    snprintf(name, size, "key-%d", key);
+}
+
+static int filter_admits(HashTable *table, int key) {
+    char name[32];
+    key_name(name, sizeof(name), key);
+    return membership_filter_may_contain(&table->filter, jenkins_one_at_a_time_hash(name), name);
+}
+
+// Queries `key` `times` times, counting each pass as a miss the table then
+// confirmed, the way SEARCH does.
+static void query_absent(HashTable *table, int key, int times) {
+    for (int i = 0; i < times; ++i) {
+        if (filter_admits(table, key)) {
+            membership_filter_note_false_positive(&table->filter);
+        }
+    }
+}
+
+// Finds an absent key the filter lets through, then drops the rejections
+// that search added to the measurement window.
+static int passing_absent_key(HashTable *table, int from) {
+    while (!filter_admits(table, from)) {
+        ++from;
+    }
+    atomic_store(&table->filter.window_rejections, 0);
+    return from;
+}
+
+static void insert_key(HashTable *table, int key) {
+    char name[32];
+    uint32_t previous;
+    int updated;
+    key_name(name, sizeof(name), key);
+    hash_table_insert_locked(table, name, (uint32_t)key, jenkins_one_at_a_time_hash(name), &previous, &updated);
+}
+
+static size_t filter_capacity(HashTable *table) {
+    FilterTable *current = atomic_load(&table->filter.current);
+    return current ? current->capacity : 0;
+}
+
+int main(void) {
+    HashTable table;
+    hash_table_init(&table);
+    char name[32];
+    uint32_t previous;
+    int updated;
+
+    // Off by default: every key is admitted and writers keep no table.
+    CHECK(!table.filter.enabled);
+    key_name(name, sizeof(name), 0);
+    hash_table_insert_locked(&table, name, 1, jenkins_one_at_a_time_hash(name), &previous, &updated);
+    CHECK(filter_admits(&table, 12345));
+    CHECK(atomic_load(&table.filter.current) == NULL);
+
+    // Enabling rebuilds from the records already present.
+    hash_table_set_filter_enabled(&table, 1);
+    CHECK(filter_admits(&table, 0));
+    for (int key = 1; key < KEYS; ++key) {
+        key_name(name, sizeof(name), key);
+        hash_table_insert_locked(&table, name, (uint32_t)key, jenkins_one_at_a_time_hash(name), &previous, &updated);
+    }
+    int missing = 0;
+    for (int key = 0; key < KEYS; ++key) {
+        missing += !filter_admits(&table, key);
+    }
+    CHECK(missing == 0);
+    CHECK(filter_capacity(&table) >= KEYS);
+    CHECK(table.filter.rebuilds > 0);
+    int admitted = 0;
+    for (int key = KEYS; key < 2 * KEYS; ++key) {
+        admitted += filter_admits(&table, key);
+    }
+    CHECK(admitted < KEYS / 20);
+
+    // Deleting most keys shrinks the filter and frees the replaced tables.
+    size_t grown = filter_capacity(&table);
+    for (int key = 0; key < KEYS - 100; ++key) {
+        key_name(name, sizeof(name), key);
+        CHECK(hash_table_delete_locked(&table, name, jenkins_one_at_a_time_hash(name), &previous) == 1);
+    }
+    CHECK(filter_capacity(&table) < grown / 4);
+    CHECK(table.filter.retired == NULL);
+    missing = 0;
+    for (int key = KEYS - 100; key < KEYS; ++key) {
+        missing += !filter_admits(&table, key);
+    }
+    CHECK(missing == 0);
+
+    // Disabled again: queries answer "maybe" and rebuilds stop.
+    hash_table_set_filter_enabled(&table, 0);
+    uint64_t rebuilds = table.filter.rebuilds;
+    CHECK(filter_admits(&table, 2 * KEYS + 1));
+    for (int key = 0; key < 2000; ++key) {
+        key_name(name, sizeof(name), key);
+        hash_table_insert_locked(&table, name, 1, jenkins_one_at_a_time_hash(name), &previous, &updated);
+    }
+    CHECK(table.filter.rebuilds == rebuilds);
+    hash_table_destroy(&table);
+
+    // Drift: one absent key that passes the filter, queried over and over.
+    hash_table_init(&table);
+    hash_table_set_filter_enabled(&table, 1);
+    for (int key = 0; key < 1000; ++key) {
+        insert_key(&table, key);
+    }
+    int absent = passing_absent_key(&table, 1000);
+    FilterTable *before = atomic_load(&table.filter.current);
+    uint32_t seed = before->seed;
+    size_t capacity = before->capacity;
+    rebuilds = table.filter.rebuilds;
+    query_absent(&table, absent, FILTER_MIN_SAMPLES);
+    insert_key(&table, 100000);
+    CHECK(table.filter.rebuilds == rebuilds + 1);
+    FilterTable *after = atomic_load(&table.filter.current);
+    CHECK(after->seed != seed);
+    CHECK(after->capacity > capacity);
+    CHECK(!filter_admits(&table, absent));
+
+    // Backoff: the next drift needs twice the samples.
+    absent = passing_absent_key(&table, absent);
+    rebuilds = table.filter.rebuilds;
+    query_absent(&table, absent, FILTER_MIN_SAMPLES);
+    insert_key(&table, 100001);
+    CHECK(table.filter.rebuilds == rebuilds);
+    query_absent(&table, absent, FILTER_MIN_SAMPLES);
+    insert_key(&table, 100002);
+    CHECK(table.filter.rebuilds == rebuilds + 1);
+    missing = 0;
+    for (int key = 0; key < 1000; ++key) {
+        missing += !filter_admits(&table, key);
+    }
+    CHECK(missing == 0);
+    hash_table_destroy(&table);
+    return check_finish("test_membership_filter");
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "check.h"
+#include "hash_table.h"
+#include "numa_topology.h"
+
+#define POOL_RECORDS 20000
+
+static void write_node(const char *root, const char *node, const char *cpulist) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", root, node);
+    mkdir(path, 0700);
+    snprintf(path, sizeof(path), "%s/%s/cpulist", root, node);
+    FILE *fp = fopen(path, "w");
+    if (fp) {
+        fputs(cpulist, fp);
+        fclose(fp);
+    }
+}
+
+static void remove_node(const char *root, const char *node) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s/cpulist", root, node);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/%s", root, node);
+    rmdir(path);
+}
+
+static char *make_root(char *path, size_t size) {
+    const char *directory = getenv("TMPDIR");
+    snprintf(path, size, "%s/chash-test-numa-XXXXXX", directory && directory[0] ? directory : "/tmp");
+    return mkdtemp(path);
+}
+
+// Fake sysfs trees: two CPU nodes plus a memory-only node, and a single node.
+static void check_topology(void) {
+    char root[256];
+    CHECK(make_root(root, sizeof(root)) != NULL);
+    write_node(root, "node1", "4-5,7\n");
+    write_node(root, "node0", "0-1\n");
+    write_node(root, "node2", "\n");
+    NumaTopology topology;
+    CHECK(numa_topology_init(&topology, root) == 0);
+    CHECK(topology.enabled && topology.node_count == 2);
+    CHECK(topology.nodes[0].id == 0 && topology.nodes[0].cpu_count == 2);
+    CHECK(topology.nodes[1].id == 1 && topology.nodes[1].cpu_count == 3);
+    CHECK(topology.nodes[1].cpus[0] == 4 && topology.nodes[1].cpus[2] == 7);
+    CHECK(numa_node_for_hash(&topology, 6) == 0 && numa_node_for_hash(&topology, 7) == 1);
+    numa_topology_destroy(&topology);
+
+    remove_node(root, "node1");
+    CHECK(numa_topology_init(&topology, root) == 0);
+    CHECK(!topology.enabled && topology.node_count == 1);
+    CHECK(numa_node_for_hash(&topology, 7) == 0);
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    CHECK(numa_pin_thread_attr(&topology, 0, &attr) == 0); // no-op on one node
+    pthread_attr_destroy(&attr);
+    numa_topology_destroy(&topology);
+    remove_node(root, "node0");
+    remove_node(root, "node2");
+    rmdir(root);
+
+    CHECK(numa_topology_init(&topology, "/nonexistent/chash") == 0);
+    CHECK(!topology.enabled && topology.node_count == 0);
+}
+
+static NumaTopology two_nodes(void) {
+    NumaTopology topology;
+    memset(&topology, 0, sizeof(topology));
+    topology.node_count = 2;
+    topology.nodes[1].id = 1;
+    topology.enabled = 1;
+    return topology;
+}
+
+// Objects come back zeroed, freed objects are reused on their own node only.
+static void check_pool(void) {
+    NumaTopology topology = two_nodes();
+    NumaObjectPool pool;
+    CHECK(numa_pool_init(&pool, &topology, 100) == 0);
+    unsigned char *first = (unsigned char *)numa_pool_alloc(&pool, 1);
+    CHECK(first != NULL);
+    memset(first, 0xAB, 100);
+    numa_pool_free(&pool, first);
+    unsigned char *other = (unsigned char *)numa_pool_alloc(&pool, 0);
+    CHECK(other != first);
+    unsigned char *again = (unsigned char *)numa_pool_alloc(&pool, 1);
+    CHECK(again == first);
+    int zeroed = 1;
+    for (size_t i = 0; i < 100; ++i) {
+        zeroed = zeroed && again[i] == 0;
+    }
+    CHECK(zeroed);
+    CHECK(((uintptr_t)again % sizeof(max_align_t)) == 0);
+    numa_pool_destroy(&pool);
+}
+
+// A table backed by the pool behaves like one using calloc.
+static void check_table_pool(void) {
+    NumaTopology topology = two_nodes();
+    NumaObjectPool pool;
+    CHECK(numa_pool_init(&pool, &topology, sizeof(hashRecord)) == 0);
+    HashTable table;
+    hash_table_init(&table);
+    hash_table_set_record_pool(&table, &pool);
+    char name[32];
+    for (int key = 0; key < POOL_RECORDS; ++key) {
+        snprintf(name, sizeof(name), "key-%d", key);
+        hash_table_insert_locked(&table, name, (uint32_t)key, jenkins_one_at_a_time_hash(name), NULL, NULL);
+    }
+    for (int key = 0; key < POOL_RECORDS; key += 2) {
+        snprintf(name, sizeof(name), "key-%d", key);
+        CHECK(hash_table_delete_locked(&table, name, jenkins_one_at_a_time_hash(name), NULL) == 1);
+    }
+    int wrong = 0;
+    for (int key = 0; key < POOL_RECORDS; ++key) {
+        snprintf(name, sizeof(name), "key-%d", key);
+        hashRecord *record = hash_table_find(&table, name, jenkins_one_at_a_time_hash(name));
+        wrong += key % 2 ? !record || record->salary != (uint32_t)key : record != NULL;
+    }
+    CHECK(wrong == 0);
+    CHECK(table.record_count == POOL_RECORDS / 2);
+    hash_table_destroy(&table);
+    numa_pool_destroy(&pool);
+}
+
+int main(void) {
+    check_topology();
+    check_pool();
+    check_table_pool();
+    return check_finish("test_numa_topology");
+}
@@ -0,0 +1,120 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+#include "output_writer.h"
+
+#define COMMITTERS 4u
+// Enough blocks that committers run past the reorder window and must wait.
+#define THREADED_BLOCKS (3u * OUTPUT_REORDER_CAPACITY)
+
+static void commit_text(OutputWriter *writer, size_t sequence, const char *text) {
+    OutputBlock block;
+    output_block_init(&block);
+    output_block_append(&block, OUTPUT_TO_FILE, text);
+    output_block_append(&block, OUTPUT_TO_CONSOLE, "console only\n");
+    CHECK(output_writer_commit(writer, sequence, &block) == 0);
+}
+
+static size_t file_length(const char *path) {
+    size_t length = 0;
+    free(check_read_file(path, &length));
+    return length;
+}
+
+typedef struct {
+    OutputWriter *writer;
+    unsigned id;
+} Committer;
+
+static void *commit_interleaved(void *arg) {
+    Committer *committer = (Committer *)arg;
+    char text[32];
+    for (size_t sequence = committer->id; sequence < THREADED_BLOCKS; sequence += COMMITTERS) {
+        snprintf(text, sizeof(text), "%zu\n", sequence);
+        commit_text(committer->writer, sequence, text);
+    }
+    return NULL;
+}
+
+static int open_writer(OutputWriter *writer, char *path, size_t size) {
+    if (check_temp_path(path, size, "chash-test-output") != 0 || output_writer_init(writer, path) != 0) {
+        return -1;
+    }
+    writer->console_fd = open("/dev/null", O_WRONLY);
+    return writer->console_fd >= 0 ? 0 : -1;
+}
+
+static void close_writer(OutputWriter *writer, const char *path) {
+    close(writer->console_fd);
+    output_writer_close(writer);
+    unlink(path);
+}
+
+int main(void) {
+    char path[256];
+    OutputWriter writer;
+    size_t length = 0;
+
+    // Blocks behind a gap wait until the gap is filled, then land in order.
+    CHECK(open_writer(&writer, path, sizeof(path)) == 0);
+    commit_text(&writer, 2, "two\n");
+    commit_text(&writer, 3, "three\n");
+    CHECK(file_length(path) == 0);
+    commit_text(&writer, 0, "zero\n");
+    char *data = check_read_file(path, &length);
+    CHECK(data && strcmp(data, "zero\n") == 0);
+    free(data);
+    commit_text(&writer, 1, "one\n");
+    data = check_read_file(path, &length);
+    CHECK(data && strcmp(data, "zero\none\ntwo\nthree\n") == 0);
+    free(data);
+
+    // A sequence already written is rejected; an empty block still closes its gap.
+    OutputBlock block;
+    output_block_init(&block);
+    output_block_append(&block, OUTPUT_TO_FILE, "late\n");
+    CHECK(output_writer_commit(&writer, 1, &block) == -1);
+    commit_text(&writer, 5, "five\n");
+    output_block_init(&block);
+    CHECK(output_writer_commit(&writer, 4, &block) == 0);
+    data = check_read_file(path, &length);
+    CHECK(data && strcmp(data, "zero\none\ntwo\nthree\nfive\n") == 0);
+    free(data);
+
+    // Blocks stranded behind a sequence that never commits are flushed on close.
+    commit_text(&writer, 8, "eight\n");
+    commit_text(&writer, 7, "seven\n");
+    close(writer.console_fd);
+    output_writer_close(&writer);
+    data = check_read_file(path, &length);
+    CHECK(data && strcmp(data, "zero\none\ntwo\nthree\nfive\nseven\neight\n") == 0);
+    free(data);
+    unlink(path);
+
+    // Concurrent committers running past the reorder window.
+    CHECK(open_writer(&writer, path, sizeof(path)) == 0);
+    pthread_t threads[COMMITTERS];
+    Committer committers[COMMITTERS];
+    for (unsigned t = 0; t < COMMITTERS; ++t) {
+        committers[t].writer = &writer;
+        committers[t].id = t;
+        CHECK(pthread_create(&threads[t], NULL, commit_interleaved, &committers[t]) == 0);
+    }
+    for (unsigned t = 0; t < COMMITTERS; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+    data = check_read_file(path, &length);
+    size_t expected = 0;
+    int ordered = data != NULL;
+    for (char *line = data ? strtok(data, "\n") : NULL; line && ordered; line = strtok(NULL, "\n")) {
+        ordered = strtoul(line, NULL, 10) == expected++;
+    }
+    CHECK(ordered && expected == THREADED_BLOCKS);
+    free(data);
+    close_writer(&writer, path);
+    return check_finish("test_output_writer");
+}
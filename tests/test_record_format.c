@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+#include "record_format.h"
+
+#define LISTING_RECORDS 40000u
+
+static const uint32_t edge_values[] = {0u, 1u, 9u, 10u, 99u, 100u, 101u, 999u, 1000u, 65535u,
+                                       99999u, 100000u, 999999999u, 1000000000u, 4294967295u};
+
+static void set_record(hashRecord *record, uint32_t hash, const char *name, uint32_t salary) {
+    memset(record, 0, sizeof(*record));
+    record->hash = hash;
+    snprintf(record->name, sizeof(record->name), "%s", name);
+    record->salary = salary;
+}
+
+// Formats with the fast path and with printf, and compares the raw bytes.
+static int matches_printf(const hashRecord *record) {
+    char fast[RECORD_LINE_MAX + 1];
+    char slow[RECORD_LINE_MAX + 1];
+    size_t length = format_record_line(fast, record);
+    int expected = snprintf(slow, sizeof(slow), "%u,%s,%u\n", record->hash, record->name, record->salary);
+    return expected >= 0 && length == (size_t)expected && memcmp(fast, slow, length) == 0;
+}
+
+int main(void) {
+    size_t value_count = sizeof(edge_values) / sizeof(edge_values[0]);
+    char longest[HASH_NAME_MAX + 1];
+    memset(longest, 'z', HASH_NAME_MAX);
+    longest[HASH_NAME_MAX] = '\0';
+    const char *names[] = {"", "a", "Jane Doe", longest};
+
+    // Every digit-count boundary in both numeric fields, with short, empty
+    // and maximum-length names.
+    hashRecord record;
+    for (size_t h = 0; h < value_count; ++h) {
+        for (size_t s = 0; s < value_count; ++s) {
+            for (size_t n = 0; n < sizeof(names) / sizeof(names[0]); ++n) {
+                set_record(&record, edge_values[h], names[n], edge_values[s]);
+                CHECK(matches_printf(&record));
+            }
+        }
+    }
+    set_record(&record, 4294967295u, longest, 4294967295u);
+    char line[RECORD_LINE_MAX + 1];
+    CHECK(format_record_line(line, &record) == RECORD_LINE_MAX);
+
+    // A listing is the concatenation of the lines, in record order.
+    hashRecord *records = (hashRecord *)calloc(LISTING_RECORDS, sizeof(hashRecord));
+    char *expected = (char *)malloc((size_t)LISTING_RECORDS * RECORD_LINE_MAX + 1);
+    CHECK(records && expected);
+    if (!records || !expected) {
+        free(records);
+        free(expected);
+        return check_finish("test_record_format");
+    }
+    size_t expected_length = 0;
+    uint32_t seed = 12345u;
+    for (uint32_t i = 0; i < LISTING_RECORDS; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        char name[32];
+        snprintf(name, sizeof(name), "employee-%u", i);
+        set_record(&records[i], seed, name, seed >> (i % 32));
+        expected_length += (size_t)sprintf(expected + expected_length, "%u,%s,%u\n", records[i].hash,
+                                           records[i].name, records[i].salary);
+    }
+    OutputBlock block;
+    output_block_init(&block);
+    CHECK(append_record_listing(&block, OUTPUT_TO_BOTH, records, LISTING_RECORDS) == 0);
+    size_t offset = 0;
+    int identical = 1;
+    for (size_t i = 0; i < block.count; ++i) {
+        const OutputSegment *segment = &block.segments[i];
+        CHECK(segment->targets == OUTPUT_TO_BOTH);
+        if (offset + segment->length > expected_length ||
+            memcmp(expected + offset, segment->data, segment->length) != 0) {
+            identical = 0;
+            break;
+        }
+        offset += segment->length;
+    }
+    CHECK(identical && offset == expected_length);
+    output_block_free(&block);
+
+    output_block_init(&block);
+    CHECK(append_record_listing(&block, OUTPUT_TO_FILE, records, 0) == 0);
+    CHECK(block.count == 0);
+    output_block_free(&block);
+    free(records);
+    free(expected);
+    return check_finish("test_record_format");
+}
@@ -0,0 +1,116 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "command_processor.h"
+#include "commands.h"
+
+static const char *const script =
+    "insert,alice,100,1\n"
+    "insert,bob,200,2\n"
+    "insert,alice,150,3\n"
+    "search,alice,4\n"
+    "search,nobody,5\n"
+    "delete,bob,6\n"
+    "delete,nobody,7\n"
+    " STATS , 8 \n";
+
+static void write_text(const char *path, const char *text) {
+    FILE *fp = fopen(path, "w");
+    fputs(text, fp);
+    fclose(fp);
+}
+
+// Reads "name=value" from a report; UINT64_MAX when the line is missing.
+static unsigned long long report_value(const char *report, const char *name) {
+    char key[64];
+    snprintf(key, sizeof(key), "\n%s=", name);
+    const char *line = strstr(report, key);
+    unsigned long long value = 0;
+    if (!line || sscanf(line + strlen(key), "%llu", &value) != 1) {
+        return (unsigned long long)-1;
+    }
+    return value;
+}
+
+static int rejects(const char *path, const char *text, const char *message) {
+    char error[160] = {0};
+    CommandList list;
+    write_text(path, text);
+    return load_commands(path, &list, error, sizeof(error)) == -1 && strstr(error, message) != NULL;
+}
+
+int main(void) {
+    char path[256];
+    char output_path[256];
+    char error[160];
+    CHECK(check_temp_path(path, sizeof(path), "chash-test-stats") == 0);
+    CHECK(check_temp_path(output_path, sizeof(output_path), "chash-test-stats") == 0);
+
+    // STATS takes a priority like PRINT, in any case and with spaces.
+    write_text(path, script);
+    CommandList list;
+    CHECK(load_commands(path, &list, error, sizeof(error)) == 0);
+    CHECK(list.size == 8);
+    CHECK(list.size == 8 && list.items[7].type == COMMAND_STATS && list.items[7].priority == 8);
+    CHECK(list.size == 8 && list.items[7].name[0] == '\0' && list.items[7].hash == 0);
+    CHECK(rejects(path, "stats\n", "Line 1: STATS expects 2 tokens"));
+    CHECK(rejects(path, "print,1\nstats,abc\n", "Line 2: Invalid priority value"));
+
+    // Run the script through the command workers and read back the report.
+    HashTable table;
+    hash_table_init(&table);
+    OutputWriter writer;
+    CHECK(output_writer_init(&writer, output_path) == 0);
+    writer.console_fd = open("/dev/null", O_WRONLY);
+    for (size_t i = 0; i < list.size; ++i) {
+        CommandContext ctx;
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.table = &table;
+        ctx.output = &writer;
+        ctx.command = list.items[i];
+        ctx.sequence = i;
+        command_worker(&ctx);
+    }
+    close(writer.console_fd);
+    output_writer_close(&writer);
+    size_t length = 0;
+    char *report = check_read_file(output_path, &length);
+    CHECK(report && strstr(report, "Table Statistics:\nrecords=1\n") != NULL);
+    if (report) {
+        CHECK(report_value(report, "lookups") == 2);
+        CHECK(report_value(report, "inserts") == 2);
+        CHECK(report_value(report, "updates") == 1);
+        CHECK(report_value(report, "deletes") == 1);
+        CHECK(report_value(report, "delete_misses") == 1);
+        CHECK(report_value(report, "read_locks") == 2); // the snapshot's own lock lands after it
+        CHECK(report_value(report, "write_locks") == 5);
+        CHECK(report_value(report, "max_probe") >= 1);
+        double average_probe = 0.0;
+        const char *line = strstr(report, "\navg_probe=");
+        CHECK(line && sscanf(line, "\navg_probe=%lf", &average_probe) == 1 && average_probe >= 1.0);
+        CHECK(strstr(report, "hot_cache_") == NULL);
+    }
+    free(report);
+
+    // The shared report adds hot-cache lines and refuses a short buffer.
+    HotCachePool pool;
+    CHECK(hot_cache_pool_init(&pool) == 0);
+    hot_cache_pool_release(&pool, hot_cache_pool_acquire(&pool));
+    char buffer[TABLE_REPORT_MAX];
+    int written = format_table_report(&table, &pool, NULL, buffer, sizeof(buffer));
+    CHECK(written > 0 && (size_t)written == strlen(buffer));
+    CHECK(strncmp(buffer, "Table Statistics:\nrecords=1\n", 28) == 0);
+    CHECK(report_value(buffer, "hot_cache_caches") == 1);
+    CHECK(format_table_report(&table, &pool, NULL, buffer, 64) == -1);
+    hot_cache_pool_destroy(&pool);
+
+    free_command_list(&list);
+    hash_table_destroy(&table);
+    unlink(path);
+    unlink(output_path);
+    return check_finish("test_stats");
+}
@@ -0,0 +1,496 @@
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table.h"
+#include "hot_cache.h"
+#include "latency_stats.h"
+#include "timestamp.h"
+
+typedef enum {
+    BENCH_SEARCH,
+    BENCH_INSERT,
+    BENCH_DELETE,
+    BENCH_PRINT,
+    BENCH_OP_COUNT
+} BenchOp;
+
+static const char *const bench_op_names[BENCH_OP_COUNT] = {"search", "insert", "delete", "print"};
+
+#define BENCH_MAX_THREADS 1024u
+#define BENCH_MAX_KEYS 10000000u
+
+typedef struct {
+    size_t threads;
+    size_t ops_per_thread;
+    size_t keys;
+    size_t prefill;
+    int zipfian;
+    double theta;
+    unsigned mix[BENCH_OP_COUNT]; // percentages
+    uint64_t seed;
+    int hot_cache;
+    int filter;
+    size_t memory_cap;
+} BenchConfig;
+
+typedef struct {
+    char name[HASH_NAME_MAX + 1];
+    uint32_t hash;
+} BenchKey;
+
+// Zipfian rank generator (Gray et al., "Quickly Generating Billion-Record Synthetic Databases").
+typedef struct {
+    size_t items;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+} Zipfian;
+
+// Holds workers until every thread exists so the timed region starts together.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int state; // 0 waiting, 1 running, -1 aborted
+} StartGate;
+
+typedef struct {
+    const BenchConfig *config;
+    const BenchKey *keys;
+    const Zipfian *zipfian;
+    HashTable *table;
+    StartGate *start;
+    uint64_t seed;
+    HotKeyCache *cache;
+    LatencyHistogram latencies[BENCH_OP_COUNT];
+} BenchWorker;
+
+static uint64_t next_random(uint64_t *state) {
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+static double next_unit(uint64_t *state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void zipfian_init(Zipfian *zipfian, size_t items, double theta) {
+    double zetan = 0.0;
+    for (size_t i = 1; i <= items; ++i) {
+        zetan += 1.0 / pow((double)i, theta);
+    }
+    double zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+    zipfian->items = items;
+    zipfian->theta = theta;
+    zipfian->alpha = 1.0 / (1.0 - theta);
+    zipfian->zetan = zetan;
+    zipfian->eta = (1.0 - pow(2.0 / (double)items, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+}
+
+static size_t zipfian_next(const Zipfian *zipfian, uint64_t *state) {
+    double u = next_unit(state);
+    double uz = u * zipfian->zetan;
+    if (uz < 1.0) {
+        return 0;
+    }
+    if (uz < 1.0 + pow(0.5, zipfian->theta)) {
+        return 1;
+    }
+    size_t rank = (size_t)((double)zipfian->items * pow(zipfian->eta * u - zipfian->eta + 1.0, zipfian->alpha));
+    return rank < zipfian->items ? rank : zipfian->items - 1;
+}
+
+static BenchOp pick_op(const BenchConfig *config, uint64_t *state) {
+    unsigned roll = (unsigned)(next_random(state) % 100u);
+    unsigned threshold = 0;
+    for (int op = 0; op < BENCH_OP_COUNT; ++op) {
+        threshold += config->mix[op];
+        if (roll < threshold) {
+            return (BenchOp)op;
+        }
+    }
+    return BENCH_SEARCH;
+}
+
+static void run_op(BenchWorker *worker, BenchOp op, const BenchKey *key, uint32_t salary) {
+    HashTable *table = worker->table;
+    switch (op) {
+        case BENCH_SEARCH: {
+            uint32_t cached_salary;
+            if (worker->cache && hot_cache_lookup(worker->cache, table, key->hash, key->name, &cached_salary)) {
+                break;
+            }
+            if (!membership_filter_may_contain(&table->filter, key->hash, key->name)) {
+                break;
+            }
+            pthread_rwlock_rdlock(&table->rwlock);
+            hashRecord *record = hash_table_find(table, key->name, key->hash);
+            volatile uint32_t found_salary = record ? record->salary : 0;
+            if (record) {
+                hot_cache_store(worker->cache, table, key->hash, key->name, record->salary);
+            } else {
+                membership_filter_note_false_positive(&table->filter);
+            }
+            (void)found_salary;
+            pthread_rwlock_unlock(&table->rwlock);
+            break;
+        }
+        case BENCH_INSERT:
+            pthread_rwlock_wrlock(&table->rwlock);
+            hash_table_insert_locked(table, key->name, salary, key->hash, NULL, NULL);
+            pthread_rwlock_unlock(&table->rwlock);
+            break;
+        case BENCH_DELETE:
+            if (!membership_filter_may_contain(&table->filter, key->hash, key->name)) {
+                break;
+            }
+            pthread_rwlock_wrlock(&table->rwlock);
+            if (hash_table_delete_locked(table, key->name, key->hash, NULL) != 1) {
+                membership_filter_note_false_positive(&table->filter);
+            }
+            pthread_rwlock_unlock(&table->rwlock);
+            break;
+        case BENCH_PRINT: {
+            size_t count = 0;
+            pthread_rwlock_rdlock(&table->rwlock);
+            hashRecord *records = hash_table_clone_records(table, &count);
+            pthread_rwlock_unlock(&table->rwlock);
+            free(records);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void *bench_worker(void *arg) {
+    BenchWorker *worker = (BenchWorker *)arg;
+    const BenchConfig *config = worker->config;
+    uint64_t state = worker->seed;
+    for (int op = 0; op < BENCH_OP_COUNT; ++op) {
+        latency_histogram_reset(&worker->latencies[op]);
+    }
+    pthread_mutex_lock(&worker->start->mutex);
+    while (worker->start->state == 0) {
+        pthread_cond_wait(&worker->start->cond, &worker->start->mutex);
+    }
+    int gate_state = worker->start->state;
+    pthread_mutex_unlock(&worker->start->mutex);
+    if (gate_state < 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < config->ops_per_thread; ++i) {
+        BenchOp op = pick_op(config, &state);
+        size_t index = config->zipfian ? zipfian_next(worker->zipfian, &state)
+                                       : (size_t)(next_random(&state) % config->keys);
+        uint32_t salary = (uint32_t)next_random(&state);
+        uint64_t start = monotonic_nanoseconds();
+        run_op(worker, op, &worker->keys[index], salary);
+        latency_histogram_record(&worker->latencies[op], monotonic_nanoseconds() - start);
+    }
+    return NULL;
+}
+
+// Accepts only a plain decimal number no larger than `max`.
+static int parse_count(const char *text, unsigned long long max, unsigned long long *out) {
+    if (!isdigit((unsigned char)text[0])) {
+        return -1;
+    }
+    char *end = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (errno != 0 || *end != '\0' || value > max) {
+        return -1;
+    }
+    *out = value;
+    return 0;
+}
+
+// Parses "search:insert:delete:print" percentages; each field must be a plain
+// decimal number and the four must add up to 100.
+static int parse_mix(const char *text, unsigned mix[BENCH_OP_COUNT]) {
+    char field[16];
+    unsigned values[BENCH_OP_COUNT];
+    unsigned total = 0;
+    for (int op = 0; op < BENCH_OP_COUNT; ++op) {
+        size_t length = strcspn(text, ":");
+        if (length >= sizeof(field) || (op + 1 < BENCH_OP_COUNT) != (text[length] == ':')) {
+            return -1;
+        }
+        memcpy(field, text, length);
+        field[length] = '\0';
+        unsigned long long value = 0;
+        if (parse_count(field, 100, &value) != 0) {
+            return -1;
+        }
+        values[op] = (unsigned)value;
+        total += values[op];
+        text += length + (text[length] == ':');
+    }
+    if (total != 100) {
+        return -1;
+    }
+    memcpy(mix, values, sizeof(values));
+    return 0;
+}
+
+static int parse_size(const char *text, size_t max, size_t *out) {
+    unsigned long long value = 0;
+    if (parse_count(text, max, &value) != 0) {
+        return -1;
+    }
+    *out = (size_t)value;
+    return 0;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [--threads N] [--ops N] [--keys N] [--prefill N]\n"
+            "          [--dist uniform|zipf] [--theta T] [--mix search:insert:delete:print] [--seed N]\n"
+            "          [--hot-cache 0|1] [--filter 0|1] [--memory-cap BYTES[K|M|G]]\n"
+            "Defaults: --threads 4 --ops 10000 --keys 4096 --prefill keys/2 --dist zipf --theta 0.99\n"
+            "          --mix 80:15:4:1 (percentages) --hot-cache 0 --filter 0 --memory-cap 0 (unlimited)\n",
+            program);
+}
+
+static int parse_args(int argc, char **argv, BenchConfig *config) {
+    int prefill_set = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char *flag = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            return -1;
+        }
+        ++i;
+        if (strcmp(flag, "--threads") == 0) {
+            if (parse_size(value, BENCH_MAX_THREADS, &config->threads) != 0) {
+                return -1;
+            }
+        } else if (strcmp(flag, "--ops") == 0) {
+            if (parse_size(value, SIZE_MAX / BENCH_MAX_THREADS, &config->ops_per_thread) != 0) {
+                return -1;
+            }
+        } else if (strcmp(flag, "--keys") == 0) {
+            if (parse_size(value, BENCH_MAX_KEYS, &config->keys) != 0) {
+                return -1;
+            }
+        } else if (strcmp(flag, "--prefill") == 0) {
+            if (parse_size(value, BENCH_MAX_KEYS, &config->prefill) != 0) {
+                return -1;
+            }
+            prefill_set = 1;
+        } else if (strcmp(flag, "--dist") == 0) {
+            if (strcmp(value, "zipf") == 0) {
+                config->zipfian = 1;
+            } else if (strcmp(value, "uniform") == 0) {
+                config->zipfian = 0;
+            } else {
+                return -1;
+            }
+        } else if (strcmp(flag, "--theta") == 0) {
+            char *end = NULL;
+            config->theta = strtod(value, &end);
+            if (end == value || *end != '\0') {
+                return -1;
+            }
+        } else if (strcmp(flag, "--mix") == 0) {
+            if (parse_mix(value, config->mix) != 0) {
+                return -1;
+            }
+        } else if (strcmp(flag, "--seed") == 0) {
+            unsigned long long seed = 0;
+            if (parse_count(value, UINT64_MAX, &seed) != 0) {
+                return -1;
+            }
+            config->seed = seed;
+        } else if (strcmp(flag, "--hot-cache") == 0) {
+            config->hot_cache = strcmp(value, "0") != 0;
+        } else if (strcmp(flag, "--filter") == 0) {
+            config->filter = strcmp(value, "0") != 0;
+        } else if (strcmp(flag, "--memory-cap") == 0) {
+            if (hash_table_parse_memory_cap(value, &config->memory_cap) != 0) {
+                return -1;
+            }
+        } else {
+            return -1;
+        }
+    }
+    if (!prefill_set) {
+        config->prefill = config->keys / 2;
+    }
+    if (config->threads == 0 || config->keys == 0 || config->prefill > config->keys) {
+        return -1;
+    }
+    if (config->memory_cap != 0 && config->memory_cap < hash_table_min_memory_cap()) {
+        fprintf(stderr, "--memory-cap must be 0 or at least %zu bytes\n", hash_table_min_memory_cap());
+        return -1;
+    }
+    if (config->zipfian && (config->theta <= 0.0 || config->theta >= 1.0)) {
+        return -1;
+    }
+    return 0;
+}
+
+static void print_report(const BenchConfig *config, const LatencyHistogram *latencies, const HotCacheStats *cache,
+                         const HashTableStats *table_stats, uint64_t elapsed_ns) {
+    uint64_t total_ops = 0;
+    for (int op = 0; op < BENCH_OP_COUNT; ++op) {
+        total_ops += latencies[op].total;
+    }
+    double seconds = (double)elapsed_ns / 1e9;
+    printf("{\"clock\":\"%s\",\"threads\":%zu,\"ops_per_thread\":%zu,\"keys\":%zu,\"prefill\":%zu,"
+           "\"distribution\":\"%s\",\"theta\":%.3f,\"seed\":%llu,",
+           timestamp_clock_source_name(), config->threads, config->ops_per_thread, config->keys, config->prefill,
+           config->zipfian ? "zipf" : "uniform", config->zipfian ? config->theta : 0.0,
+           (unsigned long long)config->seed);
+    printf("\"mix\":{\"search\":%u,\"insert\":%u,\"delete\":%u,\"print\":%u},", config->mix[BENCH_SEARCH],
+           config->mix[BENCH_INSERT], config->mix[BENCH_DELETE], config->mix[BENCH_PRINT]);
+    if (config->hot_cache) {
+        uint64_t lookups = cache->hits + cache->misses;
+        printf("\"hot_cache\":{\"hits\":%llu,\"misses\":%llu,\"hit_rate\":%.4f},", (unsigned long long)cache->hits,
+               (unsigned long long)cache->misses, lookups ? (double)cache->hits / (double)lookups : 0.0);
+    }
+    if (config->filter) {
+        printf("\"filter\":{\"rejections\":%llu,\"false_positives\":%llu,\"fp_rate\":%.4f,\"rebuilds\":%llu},",
+               (unsigned long long)table_stats->filter_rejections,
+               (unsigned long long)table_stats->filter_false_positives, table_stats->filter_fp_rate,
+               (unsigned long long)table_stats->filter_rebuilds);
+    }
+    if (config->memory_cap) {
+        printf("\"tiering\":{\"memory_cap\":%zu,\"resident\":%llu,\"cold\":%llu,\"evictions\":%llu,\"promotions\":%llu},",
+               config->memory_cap, (unsigned long long)table_stats->resident_records,
+               (unsigned long long)table_stats->cold_records, (unsigned long long)table_stats->evictions,
+               (unsigned long long)table_stats->promotions);
+    }
+    printf("\"elapsed_ns\":%llu,\"total_ops\":%llu,\"ops_per_sec\":%.1f,\"ops\":{", (unsigned long long)elapsed_ns,
+           (unsigned long long)total_ops, seconds > 0 ? (double)total_ops / seconds : 0.0);
+    for (int op = 0; op < BENCH_OP_COUNT; ++op) {
+        const LatencyHistogram *histogram = &latencies[op];
+        printf("%s\"%s\":{\"count\":%llu,\"ops_per_sec\":%.1f,\"mean_ns\":%llu,\"p50_ns\":%llu,\"p99_ns\":%llu,"
+               "\"p999_ns\":%llu,\"max_ns\":%llu}",
+               op ? "," : "", bench_op_names[op], (unsigned long long)histogram->total,
+               seconds > 0 ? (double)histogram->total / seconds : 0.0,
+               (unsigned long long)(histogram->total ? histogram->sum / histogram->total : 0),
+               (unsigned long long)latency_histogram_percentile(histogram, 50.0),
+               (unsigned long long)latency_histogram_percentile(histogram, 99.0),
+               (unsigned long long)latency_histogram_percentile(histogram, 99.9),
+               (unsigned long long)histogram->max);
+    }
+    printf("}}\n");
+}
+
+int main(int argc, char **argv) {
+    BenchConfig config = {4, 10000, 4096, 0, 1, 0.99, {80, 15, 4, 1}, 42, 0, 0, 0};
+    if (parse_args(argc, argv, &config) != 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    timestamp_init();
+
+    BenchKey *keys = (BenchKey *)calloc(config.keys, sizeof(BenchKey));
+    BenchWorker *workers = (BenchWorker *)calloc(config.threads, sizeof(BenchWorker));
+    pthread_t *threads = (pthread_t *)calloc(config.threads, sizeof(pthread_t));
+    LatencyHistogram *merged = (LatencyHistogram *)calloc(BENCH_OP_COUNT, sizeof(LatencyHistogram));
+    if (!keys || !workers || !threads || !merged) {
+        fprintf(stderr, "Failed to allocate benchmark state.\n");
+        free(keys);
+        free(workers);
+        free(threads);
+        free(merged);
+        return EXIT_FAILURE;
+    }
+
+    HashTable table;
+    hash_table_init(&table);
+    hash_table_set_filter_enabled(&table, config.filter);
+    if (hash_table_enable_tiering(&table, config.memory_cap, NULL) != 0) {
+        fprintf(stderr, "Failed to create the cold segment.\n");
+        hash_table_destroy(&table);
+        free(keys);
+        free(workers);
+        free(threads);
+        free(merged);
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < config.keys; ++i) {
+        snprintf(keys[i].name, sizeof(keys[i].name), "bench-key-%zu", i);
+        keys[i].hash = jenkins_one_at_a_time_hash(keys[i].name);
+    }
+    uint64_t prefill_state = config.seed ^ 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < config.prefill; ++i) {
+        hash_table_insert_locked(&table, keys[i].name, (uint32_t)next_random(&prefill_state), keys[i].hash, NULL, NULL);
+    }
+
+    Zipfian zipfian;
+    if (config.zipfian) {
+        zipfian_init(&zipfian, config.keys, config.theta);
+    }
+
+    StartGate start = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0};
+    size_t created = 0;
+    for (size_t i = 0; i < config.threads; ++i) {
+        workers[i].config = &config;
+        workers[i].keys = keys;
+        workers[i].zipfian = &zipfian;
+        workers[i].table = &table;
+        workers[i].start = &start;
+        workers[i].seed = (config.seed + 1) * 0x9E3779B97F4A7C15ull + i * 0xBF58476D1CE4E5B9ull;
+        workers[i].cache = NULL;
+        if (config.hot_cache) {
+            workers[i].cache = (HotKeyCache *)malloc(sizeof(HotKeyCache));
+            hot_cache_init(workers[i].cache);
+        }
+        if (pthread_create(&threads[i], NULL, bench_worker, &workers[i]) != 0) {
+            fprintf(stderr, "Failed to create benchmark thread %zu\n", i);
+            break;
+        }
+        ++created;
+    }
+    int status = created == config.threads ? EXIT_SUCCESS : EXIT_FAILURE;
+    pthread_mutex_lock(&start.mutex);
+    start.state = status == EXIT_SUCCESS ? 1 : -1;
+    uint64_t begin = monotonic_nanoseconds();
+    pthread_cond_broadcast(&start.cond);
+    pthread_mutex_unlock(&start.mutex);
+    for (size_t i = 0; i < created; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t elapsed = monotonic_nanoseconds() - begin;
+
+    if (status == EXIT_SUCCESS) {
+        HotCacheStats cache_stats = {0, 0, 0};
+        for (size_t i = 0; i < created; ++i) {
+            for (int op = 0; op < BENCH_OP_COUNT; ++op) {
+                latency_histogram_merge(&merged[op], &workers[i].latencies[op]);
+            }
+            if (workers[i].cache) {
+                ++cache_stats.caches;
+                cache_stats.hits += atomic_load(&workers[i].cache->hits);
+                cache_stats.misses += atomic_load(&workers[i].cache->misses);
+            }
+        }
+        HashTableStats table_stats;
+        hash_table_collect_stats(&table, &table_stats);
+        print_report(&config, merged, &cache_stats, &table_stats, elapsed);
+    }
+
+    hash_table_destroy(&table);
+    for (size_t i = 0; i < config.threads; ++i) {
+        free(workers[i].cache);
+    }
+    free(merged);
+    free(threads);
+    free(workers);
+    free(keys);
+    return status;
+}
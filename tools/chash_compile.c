@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "command_stream.h"
+#include "commands.h"
+
+#define DEFAULT_INPUT "commands.txt"
+#define DEFAULT_OUTPUT "commands.bin"
+
+int main(int argc, char **argv) {
+    if (argc > 3) {
+        fprintf(stderr, "Usage: %s [input.txt] [output.bin]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *input_path = argc > 1 ? argv[1] : DEFAULT_INPUT;
+    const char *output_path = argc > 2 ? argv[2] : DEFAULT_OUTPUT;
+
+    CommandList commands;
+    char error_buffer[256];
+    if (load_commands(input_path, &commands, error_buffer, sizeof(error_buffer)) != 0) {
+        fprintf(stderr, "Error loading commands: %s\n", error_buffer);
+        return EXIT_FAILURE;
+    }
+    if (command_stream_write(output_path, &commands, error_buffer, sizeof(error_buffer)) != 0) {
+        fprintf(stderr, "Error writing command stream: %s\n", error_buffer);
+        free_command_list(&commands);
+        return EXIT_FAILURE;
+    }
+    printf("Compiled %zu commands from %s to %s\n", commands.size, input_path, output_path);
+    free_command_list(&commands);
+    return EXIT_SUCCESS;
+}